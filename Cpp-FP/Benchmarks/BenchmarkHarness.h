@@ -0,0 +1,226 @@
+﻿// BenchmarkHarness.h
+// Minimal benchmark runner: calibrates an iteration count per case, times a few repetitions
+// and writes the results as JSON so runs can be compared by a script
+
+#ifndef BENCHMARK_HARNESS
+#define BENCHMARK_HARNESS
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <ostream>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#ifndef FP_BENCHMARK_CONFIG
+    #define FP_BENCHMARK_CONFIG "unknown"
+#endif
+
+namespace bench {
+
+    // Keeps the compiler from discarding a result that is never read
+    template < class Type >
+    inline void DoNotOptimize(const Type& value) {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "g"(&value) : "memory");
+#else
+        static const volatile void* sink = nullptr;
+        sink                             = &value;
+#endif
+    }
+
+    // Silences std::cout while alive, the example stages print a line per call
+    class SilenceStdout {
+      public:
+        SilenceStdout() : previous(std::cout.rdbuf(&null)) {}
+        ~SilenceStdout() { std::cout.rdbuf(previous); }
+
+        SilenceStdout(const SilenceStdout&) = delete;
+        SilenceStdout& operator=(const SilenceStdout&) = delete;
+
+      private:
+        struct NullBuffer final : std::streambuf {
+            int_type overflow(int_type c) override { return traits_type::not_eof(c); }
+        };
+
+        NullBuffer      null {};
+        std::streambuf* previous;
+    };
+
+    struct Options {
+        std::size_t minSize     = 1'000;
+        std::size_t maxSize     = 100'000'000;
+        double      minTime     = 0.05; // seconds per repetition
+        std::size_t repetitions = 3;
+        std::string filter {};
+        std::string output { "-" };
+    };
+
+    struct Result {
+        std::string name;
+        std::size_t size;
+        std::size_t iterations;
+        std::size_t repetitions;
+        double      nsPerIteration;
+        double      minNsPerIteration;
+    };
+
+    // One timed iteration over size elements, everything it needs is prepared by the factory
+    using Body    = std::function< void() >;
+    using Factory = std::function< Body(std::size_t size) >;
+
+    class Registry {
+      public:
+        // The case runs for every size of the sweep between the options and maxSize
+        void Add(std::string name, Factory factory, std::size_t maxSize = std::numeric_limits< std::size_t >::max()) {
+            cases.push_back({ std::move(name), std::move(factory), maxSize });
+        }
+
+        std::vector< Result > Run(const Options& options, std::ostream& log) const {
+            std::vector< Result > results;
+            for (const auto& benchmark : cases) {
+                if (!options.filter.empty() && benchmark.name.find(options.filter) == std::string::npos) continue;
+
+                for (std::size_t size = 1'000; size <= std::min(options.maxSize, benchmark.maxSize); size *= 10) {
+                    if (size < options.minSize) continue;
+
+                    auto body = benchmark.factory(size);
+                    results.push_back(Measure(benchmark.name, size, body, options));
+                    log << std::left << std::setw(48) << benchmark.name << std::right << std::setw(12) << size << std::setw(16) << std::fixed
+                        << std::setprecision(1) << results.back().nsPerIteration << " ns" << std::setw(12) << std::setprecision(3)
+                        << results.back().nsPerIteration / static_cast< double >(size) << " ns/element\n";
+                    if (size > std::numeric_limits< std::size_t >::max() / 10) break;
+                }
+            }
+            return results;
+        }
+
+      private:
+        struct Case {
+            std::string name;
+            Factory     factory;
+            std::size_t maxSize;
+        };
+
+        static Result Measure(const std::string& name, std::size_t size, Body& body, const Options& options) {
+            using clock = std::chrono::steady_clock;
+
+            auto timeIterations = [&body](std::size_t iterations) {
+                const auto start = clock::now();
+                for (std::size_t i = 0; i < iterations; ++i) { body(); }
+                return std::chrono::duration< double >(clock::now() - start).count();
+            };
+
+            // Warm up, then grow the iteration count until one repetition lasts minTime
+            auto        elapsed    = timeIterations(1);
+            std::size_t iterations = 1;
+            while (elapsed < options.minTime && iterations < (std::size_t { 1 } << 40)) {
+                const auto scale = elapsed > 0 ? std::clamp(options.minTime / elapsed * 1.2, 2.0, 100.0) : 100.0;
+                iterations       = static_cast< std::size_t >(static_cast< double >(iterations) * scale);
+                elapsed          = timeIterations(iterations);
+            }
+
+            std::vector< double > samples;
+            for (std::size_t r = 0; r < std::max< std::size_t >(options.repetitions, 1); ++r) {
+                samples.push_back(timeIterations(iterations) * 1e9 / static_cast< double >(iterations));
+            }
+            std::sort(samples.begin(), samples.end());
+
+            return { name, size, iterations, samples.size(), samples[samples.size() / 2], samples.front() };
+        }
+
+        std::vector< Case > cases;
+    };
+
+    inline std::string JsonEscape(std::string_view text) {
+        std::string escaped;
+        for (const auto c : text) {
+            switch (c) {
+            case '"': escaped += "\\\""; break;
+            case '\\': escaped += "\\\\"; break;
+            case '\n': escaped += "\\n"; break;
+            default:
+                if (static_cast< unsigned char >(c) < 0x20) {
+                    std::ostringstream code;
+                    code << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast< int >(c);
+                    escaped += code.str();
+                } else {
+                    escaped += c;
+                }
+            }
+        }
+        return escaped;
+    }
+
+    // Describes the build, results are only comparable between runs of the same context
+    inline std::vector< std::pair< std::string, std::string > > Context() {
+        const auto now = std::time(nullptr);
+        char       date[32] {};
+        std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+#if defined(__clang__)
+        const std::string compiler = "clang " __clang_version__;
+#elif defined(__GNUC__)
+        const std::string compiler = "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+        const std::string compiler = "msvc " + std::to_string(_MSC_VER);
+#else
+        const std::string compiler = "unknown";
+#endif
+#if defined(__AVX512F__)
+        const std::string vector = "avx512f";
+#elif defined(__AVX2__)
+        const std::string vector = "avx2";
+#elif defined(__AVX__)
+        const std::string vector = "avx";
+#elif defined(__SSE2__) || defined(_M_X64)
+        const std::string vector = "sse2";
+#else
+        const std::string vector = "none";
+#endif
+#ifdef NDEBUG
+        const std::string assertions = "false";
+#else
+        const std::string assertions = "true";
+#endif
+#ifdef FP_FIXED_POINT_DECIMAL
+        const std::string decimal = "fixed";
+#else
+        const std::string decimal = "long double";
+#endif
+
+        return { { "date", date },           { "compiler", compiler }, { "configuration", FP_BENCHMARK_CONFIG }, { "assertions", assertions },
+                 { "vector_isa", vector },   { "decimal", decimal } };
+    }
+
+    inline void WriteJson(std::ostream& out, const std::vector< Result >& results) {
+        out << "{\n  \"context\": {";
+        const auto context = Context();
+        for (std::size_t i = 0; i < context.size(); ++i) {
+            out << (i == 0 ? "\n" : ",\n") << "    \"" << context[i].first << "\": \"" << JsonEscape(context[i].second) << '"';
+        }
+        out << "\n  },\n  \"benchmarks\": [";
+        out << std::setprecision(17);
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            const auto& result = results[i];
+            out << (i == 0 ? "\n" : ",\n") << "    { \"name\": \"" << JsonEscape(result.name) << "\", \"size\": " << result.size
+                << ", \"iterations\": " << result.iterations << ", \"repetitions\": " << result.repetitions
+                << ", \"ns_per_iteration\": " << result.nsPerIteration << ", \"min_ns_per_iteration\": " << result.minNsPerIteration
+                << ", \"ns_per_element\": " << result.nsPerIteration / static_cast< double >(result.size) << " }";
+        }
+        out << "\n  ]\n}\n";
+    }
+
+} // namespace bench
+
+#endif // BENCHMARK_HARNESS
@@ -0,0 +1,71 @@
+﻿// CompositionBenchmarks.h
+// Call overhead of the CompositionFunction flavors against direct calls of the same three stages
+
+#ifndef COMPOSITION_BENCHMARKS
+#define COMPOSITION_BENCHMARKS
+
+#include "BenchmarkHarness.h"
+#include <CompositionHelper.hpp>
+#include <functional>
+#include <span>
+#include <vector>
+
+namespace benchmarks {
+
+    inline double AddTax(double x) noexcept {
+        return x * 1.2;
+    }
+    inline double Square(double x) noexcept {
+        return x * x;
+    }
+    inline double Discount(double x) noexcept {
+        return x - 10.;
+    }
+
+    inline std::vector< double > MakeDoubles(std::size_t size) {
+        std::vector< double > values(size);
+        for (std::size_t i = 0; i < size; ++i) { values[i] = static_cast< double >(i % 1000) * 0.25; }
+        return values;
+    }
+
+    // Calls function on every element, the result column is reused between iterations
+    template < class Function >
+    bench::Body MapBody(std::size_t size, Function function) {
+        return [function, data = MakeDoubles(size), result = std::vector< double >(size)]() mutable {
+            for (std::size_t i = 0; i < data.size(); ++i) { result[i] = function(data[i]); }
+            bench::DoNotOptimize(result);
+        };
+    }
+
+    inline void RegisterCompositionBenchmarks(bench::Registry& registry) {
+        registry.Add("composition/direct", [](std::size_t size) { return MapBody(size, [](double x) noexcept { return Discount(Square(AddTax(x))); }); });
+        registry.Add("composition/compose_pointers",
+                     [](std::size_t size) { return MapBody(size, fp::Compose(&AddTax, &Square).Compose(&Discount)); });
+        registry.Add("composition/compose_static", [](std::size_t size) {
+            return MapBody(size, fp::Compose(fp::StaticFunction< &AddTax > {}, fp::StaticFunction< &Square > {}).Compose(fp::StaticFunction< &Discount > {}));
+        });
+        registry.Add("composition/pipe_pointers", [](std::size_t size) { return MapBody(size, fp::Pipe(&AddTax, &Square, &Discount)); });
+        registry.Add("composition/pipe_static", [](std::size_t size) {
+            return MapBody(size, fp::Pipe(fp::StaticFunction< &AddTax > {}, fp::StaticFunction< &Square > {}, fp::StaticFunction< &Discount > {}));
+        });
+        registry.Add("composition/std_function", [](std::size_t size) {
+            std::function< double(double) > addTax = AddTax, square = Square, discount = Discount;
+            return MapBody(size, [=](double x) { return discount(square(addTax(x))); });
+        });
+
+        // Batch evaluation, stage by stage over blocks and fused per element
+        const auto batch = [](fp::BatchMode mode) {
+            return [mode](std::size_t size) -> bench::Body {
+                return [mode, function = fp::Pipe(&AddTax, &Square, &Discount), data = MakeDoubles(size), result = std::vector< double >(size)]() mutable {
+                    function.Apply(std::span< const double > { data }, std::span< double > { result }, mode);
+                    bench::DoNotOptimize(result);
+                };
+            };
+        };
+        registry.Add("composition/apply_staged", batch(fp::BatchMode::Staged));
+        registry.Add("composition/apply_fused", batch(fp::BatchMode::Fused));
+    }
+
+} // namespace benchmarks
+
+#endif // COMPOSITION_BENCHMARKS
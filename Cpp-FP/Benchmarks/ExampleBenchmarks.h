@@ -0,0 +1,94 @@
+﻿// ExampleBenchmarks.h
+// The discount and composition example workloads
+
+#ifndef EXAMPLE_BENCHMARKS
+#define EXAMPLE_BENCHMARKS
+
+#include "BenchmarkHarness.h"
+#include <CalculateDiscountsOnOrders.h>
+#include <CompositionExample.h>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+namespace benchmarks {
+
+    inline void RegisterDiscountBenchmarks(bench::Registry& registry) {
+        // Shared by every case, building the rule table is not part of the workload
+        const auto app = std::make_shared< const fp::Application >();
+
+        registry.Add("discounts/compiled", [app](std::size_t size) {
+            return [app, orders = fp::LinqContainer< fp::Order >(size)]() { bench::DoNotOptimize(app->getOrdersWithDiscount(orders)); };
+        });
+        registry.Add("discounts/uncompiled", [app](std::size_t size) {
+            return [app, orders = fp::LinqContainer< fp::Order >(size)]() { bench::DoNotOptimize(app->getOrdersWithDiscountUncompiled(orders)); };
+        });
+        registry.Add("discounts/columnar", [app](std::size_t size) {
+            return [app, orders = fp::OrderColumns(size)]() { bench::DoNotOptimize(app->getOrdersWithDiscount(orders)); };
+        });
+    }
+
+    inline void RegisterCompositionExampleBenchmarks(bench::Registry& registry) {
+        using namespace fpExample;
+
+        // Orders cycle through every configuration, as a mix of tenants would
+        struct Workload {
+            std::vector< Order >                orders;
+            std::vector< ProcessConfiguration > configs;
+        };
+        const auto makeWorkload = [](std::size_t size) {
+            auto workload = std::make_shared< Workload >();
+            workload->orders.resize(size);
+            workload->configs.resize(size);
+            for (std::size_t i = 0; i < size; ++i) {
+                workload->orders[i].date.Date = std::chrono::sys_days { std::chrono::year { 2021 } / 3 / 1 } + std::chrono::days(i % 365);
+                workload->orders[i].cost      = static_cast< double >(100 + i % 2000);
+                workload->configs[i]          = ConfigurationAt(i % configuration_count);
+            }
+            return workload;
+        };
+
+        registry.Add("composition_example/cached_per_order", [=](std::size_t size) {
+            return [workload = makeWorkload(size), app = std::make_shared< Application >()]() {
+                const bench::SilenceStdout silence {};
+                double                     total = 0;
+                for (std::size_t i = 0; i < workload->orders.size(); ++i) {
+                    total += app->CalcAdjustedCostOfOrder(workload->configs[i], InvoicingPath {}, AvailabilityPath {})(workload->orders[i]);
+                }
+                bench::DoNotOptimize(total);
+            };
+        });
+        registry.Add("composition_example/dispatch_per_order", [=](std::size_t size) {
+            return [workload = makeWorkload(size)]() {
+                const bench::SilenceStdout silence {};
+                double                     total = 0;
+                for (std::size_t i = 0; i < workload->orders.size(); ++i) {
+                    total += Application::DispatchCostOfOrder(workload->configs[i])(workload->orders[i]);
+                }
+                bench::DoNotOptimize(total);
+            };
+        });
+        registry.Add("composition_example/resolved_once", [=](std::size_t size) {
+            return [workload = makeWorkload(size), app = std::make_shared< Application >()]() {
+                const bench::SilenceStdout silence {};
+                const auto                 cost  = app->CalcAdjustedCostOfOrder(workload->configs.front(), InvoicingPath {}, AvailabilityPath {});
+                double                     total = 0;
+                for (const auto& order : workload->orders) { total += cost(order); }
+                bench::DoNotOptimize(total);
+            };
+        });
+        registry.Add("composition_example/static_configuration", [=](std::size_t size) {
+            return [workload = makeWorkload(size)]() {
+                const bench::SilenceStdout silence {};
+                const auto cost = Application::StaticCostOfOrder< InvoiceChoice::Inv1, ShippingChoice::Sh1, FreightChoice::fr1, AvailabilityChoice::AV1,
+                                                                  ShippingDateChoice::SD1 >();
+                double     total = 0;
+                for (const auto& order : workload->orders) { total += cost(order); }
+                bench::DoNotOptimize(total);
+            };
+        });
+    }
+
+} // namespace benchmarks
+
+#endif // EXAMPLE_BENCHMARKS
@@ -0,0 +1,231 @@
+﻿// LinqBenchmarks.h
+// LinqContainer operators (sequential, parallel and lazy) and linq::Enumerable, each against a hand-written loop
+
+#ifndef LINQ_BENCHMARKS
+#define LINQ_BENCHMARKS
+
+#include "BenchmarkHarness.h"
+#include <Execution.hpp>
+#include <LINQ_CPP.hpp>
+#include <LinqContainer.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <numeric>
+#include <span>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace benchmarks {
+
+    // Deterministic values in [0, 1'000'000)
+    inline std::vector< int > MakeInts(std::size_t size) {
+        std::vector< int > values(size);
+        std::uint64_t      state = 0x9E3779B97F4A7C15ull;
+        for (auto& value : values) {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            value = static_cast< int >(state % 1'000'000);
+        }
+        return values;
+    }
+
+    inline void RegisterLinqContainerBenchmarks(bench::Registry& registry) {
+        using Container = fp::LinqContainer< int >;
+
+        const auto isEven  = [](int x) { return x % 2 == 0; };
+        const auto toHalf  = [](int x) { return x * 0.5; };
+        const auto less    = [](int a, int b) { return a < b; };
+        const auto doubled = [](int x) { return static_cast< double >(x) * 2.; };
+
+        registry.Add("linq_container/select", [=](std::size_t size) { return [=, data = Container { MakeInts(size) }]() { bench::DoNotOptimize(data.Select(toHalf)); }; });
+        registry.Add("linq_container/select/par", [=](std::size_t size) {
+            return [=, data = Container { MakeInts(size) }]() { bench::DoNotOptimize(data.Select(fp::execution::par, toHalf)); };
+        });
+        registry.Add("linq_container/select/baseline", [=](std::size_t size) {
+            return [=, data = MakeInts(size)]() {
+                std::vector< double > result(data.size());
+                for (std::size_t i = 0; i < data.size(); ++i) { result[i] = toHalf(data[i]); }
+                bench::DoNotOptimize(result);
+            };
+        });
+
+        registry.Add("linq_container/where", [=](std::size_t size) { return [=, data = Container { MakeInts(size) }]() { bench::DoNotOptimize(data.Where(isEven)); }; });
+        registry.Add("linq_container/where/par", [=](std::size_t size) {
+            return [=, data = Container { MakeInts(size) }]() { bench::DoNotOptimize(data.Where(fp::execution::par, isEven)); };
+        });
+        registry.Add("linq_container/where/baseline", [=](std::size_t size) {
+            return [=, data = MakeInts(size)]() {
+                std::vector< int > result;
+                result.reserve(data.size());
+                for (const auto value : data) {
+                    if (isEven(value)) result.push_back(value);
+                }
+                bench::DoNotOptimize(result);
+            };
+        });
+
+        registry.Add("linq_container/order_by", [=](std::size_t size) { return [=, data = Container { MakeInts(size) }]() { bench::DoNotOptimize(data.OrderBy(less)); }; });
+        registry.Add("linq_container/order_by/par", [=](std::size_t size) {
+            return [=, data = Container { MakeInts(size) }]() { bench::DoNotOptimize(data.OrderBy(fp::execution::par, less)); };
+        });
+        registry.Add("linq_container/order_by/baseline", [=](std::size_t size) {
+            return [=, data = MakeInts(size)]() {
+                auto result = data;
+                std::sort(result.begin(), result.end(), less);
+                bench::DoNotOptimize(result);
+            };
+        });
+
+        registry.Add("linq_container/take", [=](std::size_t size) { return [=, data = Container { MakeInts(size) }]() { bench::DoNotOptimize(data.Take(data.size() / 2)); }; });
+        registry.Add("linq_container/take/baseline", [=](std::size_t size) {
+            return [=, data = MakeInts(size)]() {
+                std::vector< int > result(data.begin(), data.begin() + static_cast< std::ptrdiff_t >(data.size() / 2));
+                bench::DoNotOptimize(result);
+            };
+        });
+
+        registry.Add("linq_container/take_ordered", [=](std::size_t size) {
+            return [=, data = Container { MakeInts(size) }]() { bench::DoNotOptimize(data.TakeOrdered(10, less)); };
+        });
+        registry.Add("linq_container/take_ordered/baseline", [=](std::size_t size) {
+            return [=, data = MakeInts(size)]() {
+                std::vector< int > result(10);
+                std::partial_sort_copy(data.begin(), data.end(), result.begin(), result.end(), less);
+                bench::DoNotOptimize(result);
+            };
+        });
+
+        registry.Add("linq_container/average", [=](std::size_t size) { return [=, data = Container { MakeInts(size) }]() { bench::DoNotOptimize(data.Average()); }; });
+        registry.Add("linq_container/average/par", [=](std::size_t size) {
+            return [=, data = Container { MakeInts(size) }]() { bench::DoNotOptimize(data.Average(fp::execution::par)); };
+        });
+        registry.Add("linq_container/average/baseline", [=](std::size_t size) {
+            return [=, data = MakeInts(size)]() { bench::DoNotOptimize(std::accumulate(data.begin(), data.end(), 0) / static_cast< int >(data.size())); };
+        });
+
+        registry.Add("linq_container/for_each", [=](std::size_t size) {
+            return [=, data = Container { MakeInts(size) }]() mutable {
+                long long sum = 0;
+                data.ForEach([&sum](int x) { sum += x; });
+                bench::DoNotOptimize(sum);
+            };
+        });
+        registry.Add("linq_container/for_each/baseline", [=](std::size_t size) {
+            return [=, data = MakeInts(size)]() {
+                long long sum = 0;
+                for (const auto value : data) { sum += value; }
+                bench::DoNotOptimize(sum);
+            };
+        });
+
+        // Hash operators against std::unordered_map/unordered_set, keys repeat every 1000 values
+        const auto customer = [](int x) { return x % 1000; };
+
+        registry.Add("linq_container/group_by", [=](std::size_t size) {
+            return [=, data = Container { MakeInts(size) }]() { bench::DoNotOptimize(data.GroupBy(customer)); };
+        });
+        registry.Add("linq_container/group_by/par", [=](std::size_t size) {
+            return [=, data = Container { MakeInts(size) }]() { bench::DoNotOptimize(data.GroupBy(fp::execution::par, customer)); };
+        });
+        registry.Add("linq_container/group_by/baseline", [=](std::size_t size) {
+            return [=, data = MakeInts(size)]() {
+                std::unordered_map< int, std::vector< int > > groups;
+                for (const auto value : data) { groups[customer(value)].push_back(value); }
+                bench::DoNotOptimize(groups);
+            };
+        });
+
+        registry.Add("linq_container/distinct", [=](std::size_t size) { return [=, data = Container { MakeInts(size) }]() { bench::DoNotOptimize(data.Distinct()); }; });
+        registry.Add("linq_container/distinct/par", [=](std::size_t size) {
+            return [=, data = Container { MakeInts(size) }]() { bench::DoNotOptimize(data.Distinct(fp::execution::par)); };
+        });
+        registry.Add("linq_container/distinct/baseline", [=](std::size_t size) {
+            return [=, data = MakeInts(size)]() {
+                std::unordered_set< int > seen;
+                std::vector< int >        result;
+                for (const auto value : data) {
+                    if (seen.insert(value).second) result.push_back(value);
+                }
+                bench::DoNotOptimize(result);
+            };
+        });
+
+        // Every element joins the one entry of its key in a table of 1000
+        const auto pair = [](int outer, int inner) { return static_cast< long long >(outer) * inner; };
+        auto       keys = std::vector< int >(1000);
+        std::iota(keys.begin(), keys.end(), 0);
+        registry.Add("linq_container/join", [=](std::size_t size) {
+            return [=, data = Container { MakeInts(size) }, inner = Container { keys }]() { bench::DoNotOptimize(data.Join(inner, customer, std::identity {}, pair)); };
+        });
+        registry.Add("linq_container/join/par", [=](std::size_t size) {
+            return [=, data = Container { MakeInts(size) }, inner = Container { keys }]() {
+                bench::DoNotOptimize(data.Join(fp::execution::par, inner, customer, std::identity {}, pair));
+            };
+        });
+        registry.Add("linq_container/join/baseline", [=](std::size_t size) {
+            return [=, data = MakeInts(size)]() {
+                std::unordered_multimap< int, int > table;
+                for (const auto key : keys) { table.emplace(key, key); }
+                std::vector< long long > result;
+                for (const auto value : data) {
+                    const auto [first, last] = table.equal_range(customer(value));
+                    for (auto match = first; match != last; ++match) { result.push_back(pair(value, match->second)); }
+                }
+                bench::DoNotOptimize(result);
+            };
+        });
+
+        // The lazy pipeline fuses the operators into one pass without intermediate containers
+        registry.Add("linq_container/lazy_where_select_average", [=](std::size_t size) {
+            return [=, data = Container { MakeInts(size) }]() { bench::DoNotOptimize(data.AsLazy().Where(isEven).Select(doubled).Average()); };
+        });
+        registry.Add("linq_container/lazy_where_select_average/baseline", [=](std::size_t size) {
+            return [=, data = MakeInts(size)]() {
+                double      sum   = 0;
+                std::size_t count = 0;
+                for (const auto value : data) {
+                    if (isEven(value)) {
+                        sum += doubled(value);
+                        ++count;
+                    }
+                }
+                bench::DoNotOptimize(sum / static_cast< double >(count));
+            };
+        });
+    }
+
+    inline void RegisterEnumerableBenchmarks(bench::Registry& registry) {
+        const auto plusOne = [](int x) { return x + 1; };
+        const auto widen   = [](int x) { return static_cast< long long >(x) * 3; };
+        const auto sum     = [](long long total, long long x) { return total + x; };
+
+        registry.Add("enumerable/select_aggregate", [=](std::size_t size) {
+            return [=, data = MakeInts(size)]() {
+                const linq::Enumerable source(std::span< const int > { data });
+                bench::DoNotOptimize(source.Select(plusOne).Select(widen).Aggregate(0LL, sum));
+            };
+        });
+        registry.Add("enumerable/select_enumerator", [=](std::size_t size) {
+            return [=, data = MakeInts(size)]() {
+                const linq::Enumerable source(std::span< const int > { data });
+                auto                   enumerator = source.Select(plusOne).Select(widen).GetEnumerator();
+                long long              total      = 0;
+                while (enumerator.MoveNext()) { total = sum(total, enumerator.Current()); }
+                bench::DoNotOptimize(total);
+            };
+        });
+        registry.Add("enumerable/select_aggregate/baseline", [=](std::size_t size) {
+            return [=, data = MakeInts(size)]() {
+                long long total = 0;
+                for (const auto value : data) { total = sum(total, widen(plusOne(value))); }
+                bench::DoNotOptimize(total);
+            };
+        });
+    }
+
+} // namespace benchmarks
+
+#endif // LINQ_BENCHMARKS
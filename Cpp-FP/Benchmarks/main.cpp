@@ -0,0 +1,79 @@
+﻿// Benchmarks
+// Measures the FPHelper operators against hand-written loops and runs the example workloads
+//
+// Usage: Benchmarks [--filter=<substring>] [--min-size=N] [--max-size=N] [--min-time=<seconds>]
+//                   [--repetitions=N] [--output=<file.json>|-]
+// Every case runs for sizes 1'000, 10'000, ... up to --max-size (100'000'000 by default).
+// Results go to --output as JSON (stdout with -), a readable table goes to stderr.
+// Build with CMAKE_BUILD_TYPE=Release, timings of unoptimized builds are meaningless.
+
+#include "BenchmarkHarness.h"
+#include "CompositionBenchmarks.h"
+#include "ExampleBenchmarks.h"
+#include "LinqBenchmarks.h"
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace {
+    bench::Options ParseOptions(int argc, char** argv) {
+        bench::Options options {};
+        for (int i = 1; i < argc; ++i) {
+            const std::string_view argument { argv[i] };
+            const auto             separator = argument.find('=');
+            const auto             name      = argument.substr(0, separator);
+            const auto             value     = separator == std::string_view::npos ? std::string {} : std::string { argument.substr(separator + 1) };
+
+            if (name == "--filter") options.filter = value;
+            else if (name == "--min-size")
+                options.minSize = std::stoull(value);
+            else if (name == "--max-size")
+                options.maxSize = std::stoull(value);
+            else if (name == "--min-time")
+                options.minTime = std::stod(value);
+            else if (name == "--repetitions")
+                options.repetitions = std::stoull(value);
+            else if (name == "--output")
+                options.output = value;
+            else
+                throw std::invalid_argument { "Unknown option " + std::string { argument } };
+        }
+        return options;
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    bench::Options options {};
+    try {
+        options = ParseOptions(argc, argv);
+    } catch (const std::exception& error) {
+        std::cerr << error.what() << '\n';
+        return 2;
+    }
+#ifndef NDEBUG
+    std::cerr << "Warning: assertions are enabled, build the benchmarks in Release\n";
+#endif
+
+    bench::Registry registry {};
+    benchmarks::RegisterLinqContainerBenchmarks(registry);
+    benchmarks::RegisterEnumerableBenchmarks(registry);
+    benchmarks::RegisterCompositionBenchmarks(registry);
+    benchmarks::RegisterDiscountBenchmarks(registry);
+    benchmarks::RegisterCompositionExampleBenchmarks(registry);
+
+    const auto results = registry.Run(options, std::cerr);
+
+    if (options.output == "-") {
+        bench::WriteJson(std::cout, results);
+    } else {
+        std::ofstream file { options.output };
+        if (!file) {
+            std::cerr << "Cannot write " << options.output << '\n';
+            return 1;
+        }
+        bench::WriteJson(file, results);
+    }
+    return 0;
+}
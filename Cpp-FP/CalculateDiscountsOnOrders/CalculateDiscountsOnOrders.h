@@ -8,53 +8,296 @@
 #ifndef CALCULATE_DISCOUNTS_ON_ORDERS
 #define CALCULATE_DISCOUNTS_ON_ORDERS
 // Not using #pragma once since it's not a part of the standard
+#include <FixedDecimal.hpp>
+#include <InplaceFunction.hpp>
 #include <LinqContainer.hpp>
+#include <Simd.hpp>
 #include <algorithm>
 #include <array>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <span>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
 namespace fp {
 
-    // C++ does not have an equivalent to C# System.Decimal
+#ifdef FP_FIXED_POINT_DECIMAL
+    // Exact money arithmetic, 4 decimals in a 64 bits integer
+    using decimal = FixedDecimal< 4 >;
+#else
+    // C++ does not have an equivalent to C# System.Decimal, build with FP_FIXED_POINT_DECIMAL for an exact one
     using decimal = long double;
+#endif
 
     struct Order {
         Order(decimal discount_ = 0) : discount(discount_) {}
-        Order& operator=(const Order& rhs) { // Quick work-around for const members, not the best practice.
-            std::memcpy(this, &rhs, sizeof(Order));
 
-            return *this;
+        [[nodiscard]] decimal GetDiscount() const noexcept { return discount; }
+
+      private:
+        decimal discount;
+    };
+
+    /// <summary>
+    /// Orders stored column by column, each field in its own contiguous array.
+    /// Columns hold double rather than decimal: long double has no vector instructions on x86-64,
+    /// double gets 2 to 8 lanes per instruction in the fp::simd kernels.
+    /// </summary>
+    class OrderColumns {
+      public:
+        using column_type = double;
+
+        OrderColumns() = default;
+        explicit OrderColumns(std::size_t size, column_type discount = 0) : discounts(size, discount) {}
+        explicit OrderColumns(const LinqContainer< Order >& orders) {
+            discounts.reserve(orders.size());
+            for (const auto& order : orders) { push_back(order); }
+        }
+
+        void push_back(const Order& order) { discounts.push_back(static_cast< column_type >(order.GetDiscount())); }
+
+        [[nodiscard]] std::size_t size() const noexcept { return discounts.size(); }
+        [[nodiscard]] bool        empty() const noexcept { return discounts.empty(); }
+
+        [[nodiscard]] Order operator[](std::size_t index) const { return Order { decimal(discounts[index]) }; }
+
+        [[nodiscard]] std::span< const column_type > Discounts() const noexcept { return discounts; }
+        [[nodiscard]] std::span< column_type >       Discounts() noexcept { return discounts; }
+
+        [[nodiscard]] LinqContainer< Order > ToOrders() const {
+            LinqContainer< Order > orders(size());
+            std::transform(discounts.begin(), discounts.end(), orders.begin(), [](column_type discount) { return Order { decimal(discount) }; });
+            return orders;
+        }
+
+        [[nodiscard]] column_type Sum() const noexcept { return simd::Sum(Discounts()); }
+        [[nodiscard]] column_type Average() const noexcept { return simd::Average(Discounts()); }
+        [[nodiscard]] column_type Min() const noexcept { return simd::Min(Discounts()); }
+        [[nodiscard]] column_type Max() const noexcept { return simd::Max(Discounts()); }
+
+        // Evaluates predicate(discount) for every order into mask, returns how many orders match
+        template < std::predicate< column_type > Predicate >
+        std::size_t Mask(Predicate&& predicate, std::span< std::uint8_t > mask) const {
+            return simd::Mask(Discounts(), mask, std::forward< Predicate >(predicate));
         }
 
       private:
-        const decimal discount;
+        std::vector< column_type > discounts {};
     };
 
-    using QualifierFunc = std::function< bool(const Order&) >;
-    using DiscountFunc  = std::function< decimal(const Order&) >;
+    // Rules are invoked once per order, keep their callables inline rather than behind std::function
+    using QualifierFunc = InplaceFunction< bool(const Order&) >;
+    using DiscountFunc  = InplaceFunction< decimal(const Order&) >;
     using Rule          = std::pair< QualifierFunc, DiscountFunc >;
 
+    // Qualifier that does not depend on the order, folded when the rules are compiled
+    struct ConstantQualifier {
+        bool value;
+        bool operator()(const Order&) const noexcept { return value; }
+    };
+
+    // Discount that does not depend on the order, folded when the rules are compiled
+    struct ConstantDiscount {
+        decimal value;
+        decimal operator()(const Order&) const noexcept { return value; }
+    };
+
+    // Qualifier on the order discount, evaluated on whole columns as a SIMD mask, equal thresholds are grouped
+    struct DiscountAtLeast {
+        decimal threshold;
+        bool    operator()(const Order& order) const noexcept { return order.GetDiscount() >= threshold; }
+    };
+
+    // Qualifier shared by several rules, compiled rules evaluate it once per order for all of them
+    struct SharedQualifier {
+        std::shared_ptr< const QualifierFunc > qualifier;
+        bool operator()(const Order& order) const { return (*qualifier)(order); }
+    };
+
+    /// <summary>
+    /// Rule table compiled once for many orders. Computes the same discount as Application::Run, the average of
+    /// the TakeCount smallest qualifying discounts, but:
+    /// - constant qualifiers and discounts (ConstantQualifier, ConstantDiscount) are evaluated at compile time,
+    /// - rules sharing a qualifier (SharedQualifier, DiscountAtLeast with the same threshold) run it once per order,
+    /// - when no rule depends on the order the discount is computed once for every order,
+    /// - orders are processed in batches with the rule table as the outer loop, on OrderColumns the
+    ///   DiscountAtLeast qualifiers of a batch are evaluated as one vectorized mask.
+    /// Qualifiers and discounts must be pure. The rules must outlive the compiled rules.
+    /// </summary>
+    template < std::size_t TakeCount = 3 >
+    class CompiledRules {
+      public:
+        static constexpr std::size_t batch_size = 256;
+
+        explicit CompiledRules(const LinqContainer< Rule >& rules) {
+            std::unordered_map< const QualifierFunc*, std::size_t > groupOf {};
+            std::map< decimal, std::size_t >                        groupOfThreshold {};
+            for (const auto& [qualifier, discount] : rules) {
+                const auto* resolved = &qualifier;
+                if (const auto* shared = qualifier.template target< SharedQualifier >()) resolved = shared->qualifier.get();
+
+                const auto* constant = resolved->template target< ConstantQualifier >();
+                if (constant != nullptr && !constant->value) continue;
+
+                const auto* fixed = discount.template target< ConstantDiscount >();
+                if (constant != nullptr && fixed != nullptr) {
+                    unconditional.Insert(fixed->value);
+                    continue;
+                }
+
+                // Unconditional rules with an order dependent discount form the group without qualifier
+                const auto* key       = constant != nullptr ? nullptr : resolved;
+                const auto* threshold = resolved->template target< DiscountAtLeast >();
+                const auto  index     = threshold != nullptr ? groupOfThreshold.try_emplace(threshold->threshold, groups.size()).first->second
+                                                                 : groupOf.try_emplace(key, groups.size()).first->second;
+                if (index == groups.size()) {
+                    groups.push_back(Group { key, threshold != nullptr ? std::optional< decimal > { threshold->threshold } : std::nullopt, {}, {} });
+                }
+
+                auto& group = groups[index];
+                if (fixed != nullptr) {
+                    group.constants.Insert(fixed->value);
+                } else {
+                    group.discounts.push_back(&discount);
+                }
+            }
+        }
+
+        [[nodiscard]] bool IsOrderIndependent() const noexcept { return groups.empty(); }
+
+        [[nodiscard]] decimal Discount(const Order& order) const {
+            auto smallest = unconditional;
+            for (const auto& group : groups) { group.Apply(order, smallest); }
+            return smallest.Average();
+        }
+
+        [[nodiscard]] LinqContainer< Order > Apply(const LinqContainer< Order >& orders) const {
+            LinqContainer< Order > result(orders.size());
+            if (IsOrderIndependent()) {
+                const auto discount = unconditional.Average();
+                for (auto& order : result) { order = Order { discount }; }
+                return result;
+            }
+
+            std::array< Smallest, batch_size > batch {};
+            for (std::size_t first = 0; first < orders.size(); first += batch_size) {
+                const auto count  = std::min(batch_size, orders.size() - first);
+                const auto input  = orders.begin() + first;
+                const auto output = result.begin() + first;
+
+                std::fill_n(batch.begin(), count, unconditional);
+                for (const auto& group : groups) {
+                    for (std::size_t i = 0; i < count; ++i) { group.Apply(input[i], batch[i]); }
+                }
+                for (std::size_t i = 0; i < count; ++i) { output[i] = Order { batch[i].Average() }; }
+            }
+            return result;
+        }
+
+        [[nodiscard]] OrderColumns Apply(const OrderColumns& orders) const {
+            using column_type = OrderColumns::column_type;
+            if (IsOrderIndependent()) return OrderColumns(orders.size(), static_cast< column_type >(unconditional.Average()));
+
+            OrderColumns                            result(orders.size());
+            std::array< Smallest, batch_size >      batch {};
+            std::array< std::uint8_t, batch_size > mask {};
+            for (std::size_t first = 0; first < orders.size(); first += batch_size) {
+                const auto count  = std::min(batch_size, orders.size() - first);
+                const auto input  = orders.Discounts().subspan(first, count);
+                const auto output = result.Discounts().subspan(first, count);
+
+                std::fill_n(batch.begin(), count, unconditional);
+                for (const auto& group : groups) {
+                    if (group.threshold) {
+                        const auto threshold = static_cast< column_type >(*group.threshold);
+                        if (simd::Mask(input, std::span { mask }, [threshold](column_type discount) { return discount >= threshold; }) == 0) continue;
+                        for (std::size_t i = 0; i < count; ++i) {
+                            if (mask[i]) group.ApplyQualified(Order { decimal(input[i]) }, batch[i]);
+                        }
+                    } else {
+                        for (std::size_t i = 0; i < count; ++i) { group.Apply(Order { decimal(input[i]) }, batch[i]); }
+                    }
+                }
+                for (std::size_t i = 0; i < count; ++i) { output[i] = static_cast< column_type >(batch[i].Average()); }
+            }
+            return result;
+        }
+
+      private:
+        // The TakeCount smallest discounts seen so far in ascending order, what OrderBy(std::less {}).Take(TakeCount) keeps
+        struct Smallest {
+            std::array< decimal, TakeCount > values {};
+            std::size_t                      count = 0;
+
+            void Insert(decimal value) noexcept {
+                if (count == TakeCount && !(value < values[TakeCount - 1])) return;
+                auto position = count < TakeCount ? count++ : TakeCount - 1;
+                for (; position > 0 && value < values[position - 1]; --position) { values[position] = values[position - 1]; }
+                values[position] = value;
+            }
+
+            [[nodiscard]] decimal Average() const {
+                decimal sum = decimal(0);
+                for (std::size_t i = 0; i < count; ++i) { sum = sum + values[i]; }
+                return sum / count;
+            }
+        };
+
+        struct Group {
+            const QualifierFunc*               qualifier; // nullptr when every order qualifies
+            std::optional< decimal >           threshold; // set for DiscountAtLeast qualifiers
+            Smallest                           constants;
+            std::vector< const DiscountFunc* > discounts;
+
+            void Apply(const Order& order, Smallest& smallest) const {
+                if (qualifier != nullptr && !(*qualifier)(order)) return;
+                ApplyQualified(order, smallest);
+            }
+
+            void ApplyQualified(const Order& order, Smallest& smallest) const {
+                for (std::size_t i = 0; i < constants.count; ++i) { smallest.Insert(constants.values[i]); }
+                for (const auto* discount : discounts) { smallest.Insert((*discount)(order)); }
+            }
+        };
+
+        Smallest             unconditional {};
+        std::vector< Group > groups {};
+    };
+
     class Application {
       public:
         Application()  = default;
         ~Application() = default;
 
         LinqContainer< Order > getOrdersWithDiscount(LinqContainer< Order >&& ordersToProcess) const {
-            return ordersToProcess.Select([order_rules = GetDiscountRules()](const auto order) { return Run(order, order_rules); });
+            return compiledRules.Apply(ordersToProcess);
         }
 
-        LinqContainer< Order > getOrdersWithDiscount(const LinqContainer< Order >& ordersToProcess) const {
-            return ordersToProcess.Select([order_rules = GetDiscountRules()](const auto order) { return Run(order, order_rules); });
+        LinqContainer< Order > getOrdersWithDiscount(const LinqContainer< Order >& ordersToProcess) const { return compiledRules.Apply(ordersToProcess); }
+
+        OrderColumns getOrdersWithDiscount(const OrderColumns& ordersToProcess) const { return compiledRules.Apply(ordersToProcess); }
+
+        // Evaluates every rule for every order, the reference the compiled rules are checked against
+        LinqContainer< Order > getOrdersWithDiscountUncompiled(const LinqContainer< Order >& ordersToProcess) const {
+            return ordersToProcess.Select([&order_rules = GetDiscountRules()](const auto order) { return Run(order, order_rules); });
         }
 
         const LinqContainer< Rule >& GetDiscountRules() const { return rules; }
 
       protected:
         static Order Run(const Order& r, const LinqContainer< Rule >& rules) {
-            const auto discount = rules.Where([&r](const auto rule) { return rule.first(r); })
-                                      .Select([&r](const auto rule) { return rule.second(r); })
+            trace::OperatorScope scope { "Application::Run", rules.size() };
+            scope.Output(1);
+            // Lazy mode: the whole chain runs as one loop over the rules without intermediate containers
+            const auto discount = rules.AsLazy()
+                                      .Where([&r](const auto& rule) { return rule.first(r); })
+                                      .Select([&r](const auto& rule) { return rule.second(r); })
                                       .OrderBy(std::less {})
                                       .Take(3)
                                       .Average();
@@ -63,15 +306,22 @@ namespace fp {
             return newOrder;
         }
 
+        // Rules are move-only, an initializer list would have to copy them
+        template < class... Rules >
+        static LinqContainer< Rule > MakeRules(Rules&&... rules_) {
+            LinqContainer< Rule > result {};
+            (result.emplace_back(std::forward< Rules >(rules_)), ...);
+            return result;
+        }
+
         // Add more rules as convenient
-        const LinqContainer< Rule > rules { {
-            { Rule { QualifierFunc { [](const Order&) -> bool { return true; } }, DiscountFunc { [](const Order&) -> decimal { return 10.; } } } },
-            { Rule { QualifierFunc { [](const Order&) -> bool { return false; } }, DiscountFunc { [](const Order&) -> decimal { return 1.; } } } },
-            { Rule { QualifierFunc { [](const Order&) -> bool { return true; } }, DiscountFunc { [](const Order&) -> decimal { return 5.; } } } },
-            { Rule { QualifierFunc { [](const Order&) -> bool { return false; } }, DiscountFunc { [](const Order&) -> decimal { return 20.; } } } },
-            { Rule { QualifierFunc { [](const Order&) -> bool { return true; } }, DiscountFunc { [](const Order&) -> decimal { return 2.; } } } },
-            { Rule { QualifierFunc { [](const Order&) -> bool { return true; } }, DiscountFunc { [](const Order&) -> decimal { return 3.; } } } },
-        } };
+        const LinqContainer< Rule > rules = MakeRules(
+            Rule { ConstantQualifier { true }, ConstantDiscount { 10 } }, Rule { ConstantQualifier { false }, ConstantDiscount { 1 } },
+            Rule { ConstantQualifier { true }, ConstantDiscount { 5 } }, Rule { ConstantQualifier { false }, ConstantDiscount { 20 } },
+            Rule { ConstantQualifier { true }, ConstantDiscount { 2 } }, Rule { ConstantQualifier { true }, ConstantDiscount { 3 } });
+
+        // Compiled after rules, declaration order matters
+        const CompiledRules<> compiledRules { rules };
     };
 
 }; // namespace fp
@@ -8,6 +8,7 @@
 #include "CalculateDiscountsOnOrders.h"
 
 #include <LINQ_CPP.hpp>
+#include <Tracing.hpp>
 #include <Traits.hpp>
 #include <functional>
 #include <iostream>
@@ -15,6 +16,10 @@
 #include <type_traits>
 
 int main() {
+    // Built with FP_ENABLE_TRACING, every operator is reported on stderr at the end
+    fp::trace::Collector             collector {};
+    const fp::trace::ScopedCollector tracing { collector };
+
     // construct our application with fake 4 orders
     fp::Application app {};
 
@@ -23,14 +28,24 @@ int main() {
     std::vector< fp::Order > some_orders { {}, {}, {}, {} };
     auto                     more_discounts = app.getOrdersWithDiscount(some_orders);
 
-    fp::CompositionFunction< void(void), void >::return_type;
+    // The compiled rules must agree with evaluating every rule for every order
+    auto reference = app.getOrdersWithDiscountUncompiled(some_orders);
+    for (std::size_t i = 0; i < reference.size(); ++i) {
+        if (reference.at(i).GetDiscount() != more_discounts.at(i).GetDiscount()) return 1;
+    }
+
+    // Columnar orders go through the same rules, their aggregates run as SIMD kernels
+    const auto columnar_discounts = app.getOrdersWithDiscount(fp::OrderColumns { reference });
+    std::cout << "Average discount: " << columnar_discounts.Average() << ", max: " << columnar_discounts.Max() << '\n';
+
+    static_assert(std::is_void_v< fp::CompositionFunction< void(void), void >::return_type >);
 
     linq::Enumerable cont { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
     auto             result = cont.Select([](int x) -> double { return static_cast< double >(x) * x; });
 
     auto enumerator = result.GetEnumerator();
 
-    while (enumerator->MoveNext()) { std::cout << enumerator->Current() << '\n'; }
+    while (enumerator.MoveNext()) { std::cout << enumerator.Current() << '\n'; }
     linq::Enumerable fruits      = { "apple", "mango", "orange", "passionfruit", "grape" };
     std::string      longestName = fruits.Aggregate(
         "banana",
@@ -69,4 +84,6 @@ int main() {
     std::string reversed = words.Aggregate([](auto workingSentence, auto next) { return next + " " + workingSentence; });
 
     std::cout << reversed << '\n';
+
+    if constexpr (fp::trace::enabled) collector.WriteReport(std::cerr);
 }
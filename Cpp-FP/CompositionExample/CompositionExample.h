@@ -13,62 +13,118 @@
 #include <stdint.h>
 #include <array>
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <iostream>
+#include <span>
+#include <stdexcept>
 #include <string>
 #include <utility>
 #include "CompositionExampleTypes.h"
 #include <FPUtility.hpp>
+#include <InplaceFunction.hpp>
+#include <LruCache.hpp>
 
 namespace fpExample {
 
     class Application {
       private:
         static decltype(auto) InvoicePathFunc(ProcessConfiguration config, InvoicingPath invPath) {
-            auto p = fp::Compose(invPath.invoiceFunctions.Where([&](InvoiceChooser x) { return x.invoiceChoice == config.invoiceChoice; })
-                                     .Select([](InvoiceChooser x) { return x.calcInvoice; })
-                                     .FirstOrDefault(),
-                                 invPath.shippingFunctions.Where([&](ShippingChooser x) { return x.shippingChoice == config.shippingChoice; })
-                                     .Select([](ShippingChooser x) { return x.calcShipping; })
-                                     .FirstOrDefault())
-                         .Compose(invPath.freightFunctions.Where([&](FreightChooser x) { return x.freightChoice == config.freightChoice; })
-                                      .Select([](FreightChooser x) { return x.calcFreight; })
-                                      .FirstOrDefault());
+            auto p = fp::Pipe(invPath.invoiceIndex.FindOrDefault(config.invoiceChoice), invPath.shippingIndex.FindOrDefault(config.shippingChoice),
+                              invPath.freightIndex.FindOrDefault(config.freightChoice));
 
             return p;
         }
 
         static decltype(auto) AvailabilityPathFunc(ProcessConfiguration config, AvailabilityPath avPath) {
-            auto p = fp::Compose(avPath.availabilityFunctions.Where([&](AvailabilityChooser x) { return x.availabilityChoice == config.availabilityChoice; })
-                                     .Select([](AvailabilityChooser x) { return x.calcAvailability; })
-                                     .FirstOrDefault(),
-                                 avPath.shippingDateFunctions.Where([&](ShippingDateChooser x) { return x.shippingDateChoice == config.shippingDateChoice; })
-                                     .Select([](ShippingDateChooser x) { return x.calcShippingDate; })
-                                     .FirstOrDefault());
+            auto p = fp::Compose(avPath.availabilityIndex.FindOrDefault(config.availabilityChoice),
+                                 avPath.shippingDateIndex.FindOrDefault(config.shippingDateChoice));
 
             return p;
         }
 
+        template < class InvoiceFunc, class AvailabilityFunc >
+        static double AdjustCost(Order r, const InvoiceFunc& fr, const AvailabilityFunc& sh) noexcept {
+            auto f         = fr(r);
+            auto s         = sh(r);
+            auto dayString = fp::zellersAlgorithm(uint32_t(s.date.Date.day()), uint32_t(s.date.Date.month()), int { s.date.Date.year() });
+            std::cout << "\n\nDate of shipping: " << dayString << '\n';
+
+            double cost = dayString == "Monday" ? f.cost + 1000 : f.cost + 500;
+
+            return cost;
+        }
+
+        template < std::size_t Index >
+        static double StaticCostAt(Order r) noexcept {
+            constexpr auto config = ConfigurationAt(Index);
+            return StaticCostOfOrder< config.invoiceChoice, config.shippingChoice, config.freightChoice, config.availabilityChoice,
+                                      config.shippingDateChoice >()(r);
+        }
+
       public:
-        Application()  = default;
+        // Fully composed cost of an order for one configuration
+        using CostFunction = fp::InplaceFunction< double(Order), 8 * sizeof(void*) >;
+
+        // By default every configuration fits, nothing is ever evicted
+        explicit Application(std::size_t cachedConfigurations = configuration_count) : costFunctions(cachedConfigurations) {}
         ~Application() = default;
 
-        decltype(auto) CalcAdjustedCostOfOrder(ProcessConfiguration config, InvoicingPath invPath, AvailabilityPath avPath) const noexcept {
-            auto AdjustCost = [](Order r, auto&& fr, auto&& sh) noexcept {
-                auto f         = fr(r);
-                auto s         = sh(r);
-                auto dayString = fp::zellersAlgorithm(uint32_t(s.date.Date.day()), uint32_t(s.date.Date.month()), int { s.date.Date.year() });
-                std::cout << "\n\nDate of shipping: " << dayString << '\n';
+        // Composes the cost function of a configuration, CalcAdjustedCostOfOrder caches the result
+        static CostFunction BuildCostOfOrder(ProcessConfiguration config, InvoicingPath invPath, AvailabilityPath avPath) {
+            // The configuration is resolved once, the returned function owns everything it calls
+            return [invoice = InvoicePathFunc(config, invPath), availability = AvailabilityPathFunc(config, avPath)](Order r) {
+                return AdjustCost(r, invoice, availability);
+            };
+        }
 
-                double cost = dayString == "Monday" ? f.cost + 1000 : f.cost + 500;
+        // Freight of a batch of orders, each stage of the invoicing path runs over a block of orders before the next one
+        static void CalcFreightOfOrders(ProcessConfiguration config, InvoicingPath invPath, std::span< const Order > orders, std::span< Freight > freights) {
+            InvoicePathFunc(config, invPath).Apply(orders, freights);
+        }
 
-                return cost;
-            };
+        // Thread-safe, the cost function of a configuration is composed on first use and shared afterwards
+        decltype(auto) CalcAdjustedCostOfOrder(ProcessConfiguration config, InvoicingPath invPath, AvailabilityPath avPath) const {
+            auto cost = costFunctions.GetOrAdd(PackConfiguration(config), [&] { return BuildCostOfOrder(config, invPath, avPath); });
 
-            auto return_function = [&](Order r) { return AdjustCost(r, InvoicePathFunc(config, invPath), AvailabilityPathFunc(config, avPath)); };
+            auto return_function = [cost = std::move(cost)](Order r) {
+                fp::trace::OperatorScope scope { "CalcAdjustedCostOfOrder", 1 };
+                scope.Output(1);
+                return (*cost)(r);
+            };
 
             return return_function;
         }
+
+        // Cost function of a configuration fixed at compile time: a chain of direct calls with no lookup and nothing stored
+        template < InvoiceChoice Inv, ShippingChoice Sh, FreightChoice Fr, AvailabilityChoice Av, ShippingDateChoice Sd >
+        static constexpr auto StaticCostOfOrder() noexcept {
+            auto invoice = fp::Pipe(fp::StaticFunction< StaticPaths::invoice[fp::impl::EnumIndex(Inv)] > {},
+                                    fp::StaticFunction< StaticPaths::shipping[fp::impl::EnumIndex(Sh)] > {},
+                                    fp::StaticFunction< StaticPaths::freight[fp::impl::EnumIndex(Fr)] > {});
+            auto availability = fp::Compose(fp::StaticFunction< StaticPaths::availability[fp::impl::EnumIndex(Av)] > {},
+                                            fp::StaticFunction< StaticPaths::shippingDate[fp::impl::EnumIndex(Sd)] > {});
+
+            return [invoice, availability](Order r) noexcept { return AdjustCost(r, invoice, availability); };
+        }
+
+        using CostOfOrderPointer = double (*)(Order) noexcept;
+
+        // Run-time choice among the compile-time cost functions: one table load, then a single indirect call per order
+        static CostOfOrderPointer DispatchCostOfOrder(ProcessConfiguration config) {
+            static constexpr auto table = []< std::size_t... Index >(std::index_sequence< Index... >) {
+                return std::array< CostOfOrderPointer, sizeof...(Index) > { &StaticCostAt< Index >... };
+            }(std::make_index_sequence< configuration_count > {});
+
+            if (!IsValidConfiguration(config)) throw std::out_of_range { "Configuration has a choice outside of its enumeration" };
+            return table[ConfigurationIndex(config)];
+        }
+
+        [[nodiscard]] const fp::LruCache< std::uint64_t, CostFunction >& CostFunctionCache() const noexcept { return costFunctions; }
+
+      private:
+        mutable fp::LruCache< std::uint64_t, CostFunction > costFunctions;
     };
 
 } // namespace fpExample
@@ -4,7 +4,11 @@
 
 #include <CompositionHelper.hpp>
 #include <LinqContainer.hpp>
+#include <Lookup.hpp>
 #include <stdint.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
 
 namespace fpExample {
 
@@ -21,6 +25,22 @@ namespace fpExample {
 
     enum class ShippingDateChoice : std::uint8_t { SD1, SD2, SD3, SD4, SD5 };
 
+} // namespace fpExample
+
+// Number of choices, the chooser tables are indexed by them
+template <>
+struct fp::enum_size< fpExample::InvoiceChoice > : std::integral_constant< std::size_t, 5 > {};
+template <>
+struct fp::enum_size< fpExample::ShippingChoice > : std::integral_constant< std::size_t, 3 > {};
+template <>
+struct fp::enum_size< fpExample::FreightChoice > : std::integral_constant< std::size_t, 6 > {};
+template <>
+struct fp::enum_size< fpExample::AvailabilityChoice > : std::integral_constant< std::size_t, 4 > {};
+template <>
+struct fp::enum_size< fpExample::ShippingDateChoice > : std::integral_constant< std::size_t, 5 > {};
+
+namespace fpExample {
+
     struct ProcessConfiguration {
         InvoiceChoice      invoiceChoice;
         ShippingChoice     shippingChoice;
@@ -29,6 +49,50 @@ namespace fpExample {
         ShippingDateChoice shippingDateChoice;
     };
 
+    // Number of distinct configurations, one per combination of choices
+    inline constexpr std::size_t configuration_count = fp::enum_size< InvoiceChoice >::value * fp::enum_size< ShippingChoice >::value *
+                                                       fp::enum_size< FreightChoice >::value * fp::enum_size< AvailabilityChoice >::value *
+                                                       fp::enum_size< ShippingDateChoice >::value;
+
+    // Position of the configuration in [0, configuration_count), the choices are the digits of a mixed radix number
+    constexpr std::size_t ConfigurationIndex(const ProcessConfiguration& config) noexcept {
+        auto index = fp::impl::EnumIndex(config.invoiceChoice);
+        index      = index * fp::enum_size< ShippingChoice >::value + fp::impl::EnumIndex(config.shippingChoice);
+        index      = index * fp::enum_size< FreightChoice >::value + fp::impl::EnumIndex(config.freightChoice);
+        index      = index * fp::enum_size< AvailabilityChoice >::value + fp::impl::EnumIndex(config.availabilityChoice);
+        return index * fp::enum_size< ShippingDateChoice >::value + fp::impl::EnumIndex(config.shippingDateChoice);
+    }
+
+    // Inverse of ConfigurationIndex
+    constexpr ProcessConfiguration ConfigurationAt(std::size_t index) noexcept {
+        ProcessConfiguration config {};
+        config.shippingDateChoice = static_cast< ShippingDateChoice >(index % fp::enum_size< ShippingDateChoice >::value);
+        index /= fp::enum_size< ShippingDateChoice >::value;
+        config.availabilityChoice = static_cast< AvailabilityChoice >(index % fp::enum_size< AvailabilityChoice >::value);
+        index /= fp::enum_size< AvailabilityChoice >::value;
+        config.freightChoice = static_cast< FreightChoice >(index % fp::enum_size< FreightChoice >::value);
+        index /= fp::enum_size< FreightChoice >::value;
+        config.shippingChoice = static_cast< ShippingChoice >(index % fp::enum_size< ShippingChoice >::value);
+        config.invoiceChoice  = static_cast< InvoiceChoice >(index / fp::enum_size< ShippingChoice >::value);
+        return config;
+    }
+
+    constexpr bool IsValidConfiguration(const ProcessConfiguration& config) noexcept {
+        return fp::impl::EnumIndex(config.invoiceChoice) < fp::enum_size< InvoiceChoice >::value &&
+               fp::impl::EnumIndex(config.shippingChoice) < fp::enum_size< ShippingChoice >::value &&
+               fp::impl::EnumIndex(config.freightChoice) < fp::enum_size< FreightChoice >::value &&
+               fp::impl::EnumIndex(config.availabilityChoice) < fp::enum_size< AvailabilityChoice >::value &&
+               fp::impl::EnumIndex(config.shippingDateChoice) < fp::enum_size< ShippingDateChoice >::value;
+    }
+
+    // One byte per choice, equal configurations have equal keys
+    constexpr std::uint64_t PackConfiguration(const ProcessConfiguration& config) noexcept {
+        return std::uint64_t { static_cast< std::uint8_t >(config.invoiceChoice) } | std::uint64_t { static_cast< std::uint8_t >(config.shippingChoice) } << 8 |
+               std::uint64_t { static_cast< std::uint8_t >(config.freightChoice) } << 16 |
+               std::uint64_t { static_cast< std::uint8_t >(config.availabilityChoice) } << 24 |
+               std::uint64_t { static_cast< std::uint8_t >(config.shippingDateChoice) } << 32;
+    }
+
     struct DateTime {
         std::chrono::year_month_day                 Date;
         std::chrono::hh_mm_ss< std::chrono::hours > Time;
@@ -262,6 +326,11 @@ namespace fpExample {
             { FreightChoice::fr3, FreightFunction::calcFreightCost3 }, { FreightChoice::fr4, FreightFunction::calcFreightCost4 },
             { FreightChoice::fr5, FreightFunction::calcFreightCost5 }, { FreightChoice::fr6, FreightFunction::calcFreightCost6 },
         };
+
+        // Indexes over the tables above, a choice is resolved with one array load
+        inline static const auto invoiceIndex  = invoiceFunctions.ToDictionary(&InvoiceChooser::invoiceChoice, &InvoiceChooser::calcInvoice);
+        inline static const auto shippingIndex = shippingFunctions.ToDictionary(&ShippingChooser::shippingChoice, &ShippingChooser::calcShipping);
+        inline static const auto freightIndex  = freightFunctions.ToDictionary(&FreightChooser::freightChoice, &FreightChooser::calcFreight);
     };
 
     struct AvailabilityChooser {
@@ -284,6 +353,31 @@ namespace fpExample {
             { ShippingDateChoice::SD3, ShippingDateFunction::calcShippingDate3 }, { ShippingDateChoice::SD4, ShippingDateFunction::calcShippingDate4 },
             { ShippingDateChoice::SD5, ShippingDateFunction::calcShippingDate5 },
         };
+
+        // Indexes over the tables above, a choice is resolved with one array load
+        inline static const auto availabilityIndex =
+            availabilityFunctions.ToDictionary(&AvailabilityChooser::availabilityChoice, &AvailabilityChooser::calcAvailability);
+        inline static const auto shippingDateIndex =
+            shippingDateFunctions.ToDictionary(&ShippingDateChooser::shippingDateChoice, &ShippingDateChooser::calcShippingDate);
+    };
+
+    // Compile-time counterparts of the paths, one function per enumerator in enumerator order.
+    // A choice known at compile time names its function directly: fp::StaticFunction< StaticPaths::invoice[index] >
+    struct StaticPaths {
+        static constexpr std::array invoice { &InvoiceFunction::calcInvoice1, &InvoiceFunction::calcInvoice2, &InvoiceFunction::calcInvoice3,
+                                              &InvoiceFunction::calcInvoice4, &InvoiceFunction::calcInvoice5 };
+        static constexpr std::array shipping { &ShippingFunction::calShipping1, &ShippingFunction::calShipping2, &ShippingFunction::calShipping3 };
+        static constexpr std::array freight { &FreightFunction::calcFreightCost1, &FreightFunction::calcFreightCost2, &FreightFunction::calcFreightCost3,
+                                              &FreightFunction::calcFreightCost4, &FreightFunction::calcFreightCost5, &FreightFunction::calcFreightCost6 };
+        static constexpr std::array availability { &AvailabilityFunction::calcAvailability1, &AvailabilityFunction::calcAvailability2,
+                                                   &AvailabilityFunction::calcAvailability3, &AvailabilityFunction::calcAvailability4 };
+        static constexpr std::array shippingDate { &ShippingDateFunction::calcShippingDate1, &ShippingDateFunction::calcShippingDate2,
+                                                   &ShippingDateFunction::calcShippingDate3, &ShippingDateFunction::calcShippingDate4,
+                                                   &ShippingDateFunction::calcShippingDate5 };
+
+        static_assert(invoice.size() == fp::enum_size< InvoiceChoice >::value && shipping.size() == fp::enum_size< ShippingChoice >::value &&
+                      freight.size() == fp::enum_size< FreightChoice >::value && availability.size() == fp::enum_size< AvailabilityChoice >::value &&
+                      shippingDate.size() == fp::enum_size< ShippingDateChoice >::value);
     };
 
 } // namespace fpExample
@@ -10,6 +10,10 @@
 int main() {
     using namespace fpExample;
 
+    // Built with FP_ENABLE_TRACING, every composed stage is reported on stderr at the end
+    fp::trace::Collector             collector {};
+    const fp::trace::ScopedCollector tracing { collector };
+
     Application app {};
 
     ProcessConfiguration config {};
@@ -29,4 +33,23 @@ int main() {
     auto CostOfOrder = app.CalcAdjustedCostOfOrder(config, InvoicingPath {}, AvailabilityPath {});
 
     std::cout << "Cost of order:" << CostOfOrder(order);
+
+    // The same configuration fixed at compile time, and chosen from the compile-time table at run time
+    const auto StaticCostOfOrder = Application::StaticCostOfOrder< InvoiceChoice::Inv3, ShippingChoice::Sh2, FreightChoice::fr3, AvailabilityChoice::AV2,
+                                                                   ShippingDateChoice::SD2 >();
+    const auto DispatchedCostOfOrder = Application::DispatchCostOfOrder(config);
+
+    const auto cost = CostOfOrder(order);
+    if (StaticCostOfOrder(order) != cost || DispatchedCostOfOrder(order) != cost) return 1;
+    std::cout << "\nCost of order (compile-time configuration):" << cost << "\n\n";
+
+    // A batch of orders through the invoicing path, stage by stage
+    std::array< Order, 3 > orders { order, order, order };
+    orders[1].cost = 500;
+    orders[2].cost = 1500;
+    std::array< Freight, 3 > freights {};
+    Application::CalcFreightOfOrders(config, InvoicingPath {}, orders, freights);
+    for (const auto& freight : freights) { std::cout << "\nFreight of order:" << freight.cost; }
+
+    if constexpr (fp::trace::enabled) collector.WriteReport(std::cerr);
 }
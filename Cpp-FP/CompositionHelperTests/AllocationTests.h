@@ -0,0 +1,84 @@
+﻿// AllocationTests.h
+// Allocation budgets of the steady-state paths, counted by AllocationTracking.h
+
+#ifndef ALLOCATION_TESTS
+#define ALLOCATION_TESTS
+
+#include "AllocationTracking.h"
+#include <CompositionHelper.hpp>
+#include <InplaceFunction.hpp>
+#include <LINQ_CPP.hpp>
+#include <LinqContainer.hpp>
+#include <LruCache.hpp>
+#include <cassert>
+#include <functional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace allocation_tests {
+    double AddTax(double x) noexcept {
+        return x * 1.2;
+    }
+    double Discount(double x) noexcept {
+        return x - 10.;
+    }
+} // namespace allocation_tests
+
+void test_allocation_budgets() {
+    using alloc_tracking::CountAllocations;
+    using namespace allocation_tests;
+
+    // The harness sees what it should
+    const auto counted = CountAllocations([] { delete new std::vector< int >(100); });
+    assert(counted.allocations == 2 && counted.deallocations == 2 && counted.bytes >= sizeof(std::vector< int >) + 100 * sizeof(int));
+
+    // Calling a composed function never allocates
+    auto composed = fp::Compose(&AddTax, &Discount).Compose([](double x) { return x * 2; });
+    auto pipe     = fp::Pipe(fp::StaticFunction< &AddTax > {}, fp::StaticFunction< &Discount > {});
+    auto erased   = fp::InplaceFunction< double(double) > { composed };
+    auto result   = 0.;
+    assert(CountAllocations([&] {
+               for (auto i = 0; i < 100; ++i) { result += composed(i) + pipe(i) + erased(i); }
+           }).allocations == 0);
+    assert(result != 0);
+
+    // Batch evaluation keeps its blocks on the stack
+    std::vector< double > input(1000, 2.), output(1000);
+    assert(CountAllocations([&] { composed.Apply(std::span< const double > { input }, std::span< double > { output }); }).allocations == 0);
+
+    // Reductions over a LinqContainer do not allocate, sequential Where/Select allocate their result once
+    const fp::LinqContainer< int > numbers { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+    const auto                     isEven = [](int x) { return x % 2 == 0; };
+    assert(CountAllocations([&] { result = numbers.Average(); }).allocations == 0);
+    assert(CountAllocations([&] { result = numbers.FirstOrDefault(); }).allocations == 0);
+    assert(CountAllocations([&] { assert(numbers.Where(isEven).size() == 5); }).allocations == 1);
+    assert(CountAllocations([&] { assert(numbers.Select([](int x) { return x * 0.5; }).size() == 10); }).allocations == 1);
+
+    // Lazy pipelines without a buffering operator run without allocating
+    assert(CountAllocations([&] { result = numbers.AsLazy().Where(isEven).Select([](int x) { return x * 2; }).Take(3).Average(); }).allocations == 0);
+    assert(result == 8);
+    // OrderBy(...).Take(n) only grows its bounded heap of n elements
+    assert(CountAllocations([&] { result = numbers.AsLazy().OrderBy(std::greater {}).Take(2).Average(); }).allocations <= 2);
+
+    // Statically composed Enumerable queries neither
+    const linq::Enumerable values(std::span< const int > { numbers.begin(), numbers.end() });
+    assert(CountAllocations([&] { result = values.Select([](int x) { return x + 1; }).Aggregate(0, std::plus {}); }).allocations == 0);
+    assert(result == 65);
+
+    // Erased enumerators reuse their pooled node from the second query on
+    auto                      erasedValues = values.AsIEnumerable();
+    linq::IEnumerable< int >& enumerable   = erasedValues;
+    enumerable.GetEnumerator().reset();
+    assert(CountAllocations([&] {
+               auto enumerator = enumerable.GetEnumerator();
+               while (enumerator->MoveNext()) { result += enumerator->Current(); }
+           }).allocations == 0);
+
+    // Cache hits hand out the shared value
+    fp::LruCache< int, std::string > cache { 4 };
+    cache.Put(1, std::string(64, 'x'));
+    assert(CountAllocations([&] { assert(cache.Find(1)->size() == 64); }).allocations == 0);
+}
+
+#endif // ALLOCATION_TESTS
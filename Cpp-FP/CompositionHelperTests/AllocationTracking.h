@@ -0,0 +1,127 @@
+﻿// AllocationTracking.h
+// Counts the global operator new/delete calls of each thread, so tests can assert allocation budgets
+//
+// The replacement operators below are defined here and not inline: include this header from main.cpp only
+
+#ifndef ALLOCATION_TRACKING
+#define ALLOCATION_TRACKING
+
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <utility>
+
+namespace alloc_tracking {
+
+    struct Counts {
+        std::size_t allocations   = 0;
+        std::size_t deallocations = 0;
+        std::size_t bytes         = 0;
+    };
+
+    // Per thread, work done by the scheduler's workers is not counted against the test thread
+    inline constinit thread_local Counts counts {};
+
+    inline void* Allocate(std::size_t size, std::size_t alignment) noexcept {
+        size = size == 0 ? 1 : size;
+        ++counts.allocations;
+        counts.bytes += size;
+        if (alignment <= alignof(std::max_align_t)) return std::malloc(size);
+        return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+    }
+
+    inline void Deallocate(void* ptr) noexcept {
+        if (ptr == nullptr) return;
+        ++counts.deallocations;
+        std::free(ptr);
+    }
+
+    inline void* AllocateOrThrow(std::size_t size, std::size_t alignment) {
+        if (void* ptr = Allocate(size, alignment)) return ptr;
+        throw std::bad_alloc {};
+    }
+
+    // Allocations made on the calling thread while function runs
+    template < class Function >
+    Counts CountAllocations(Function&& function) {
+        const auto before = counts;
+        std::forward< Function >(function)();
+        return { counts.allocations - before.allocations, counts.deallocations - before.deallocations, counts.bytes - before.bytes };
+    }
+
+    // Runs one test and prints what it allocated
+    template < class Test >
+    void RunTest(const char* name, Test&& test) {
+        const auto used = CountAllocations(std::forward< Test >(test));
+        std::cout << name << ": " << used.allocations << " allocations, " << used.deallocations << " deallocations, " << used.bytes << " bytes\n";
+    }
+
+} // namespace alloc_tracking
+
+#define RUN_TEST(test) alloc_tracking::RunTest(#test, test)
+
+// Replacements of the global allocation functions, every other form forwards to these
+void* operator new(std::size_t size) {
+    return alloc_tracking::AllocateOrThrow(size, alignof(std::max_align_t));
+}
+void* operator new[](std::size_t size) {
+    return alloc_tracking::AllocateOrThrow(size, alignof(std::max_align_t));
+}
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return alloc_tracking::AllocateOrThrow(size, static_cast< std::size_t >(alignment));
+}
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return alloc_tracking::AllocateOrThrow(size, static_cast< std::size_t >(alignment));
+}
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return alloc_tracking::Allocate(size, alignof(std::max_align_t));
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return alloc_tracking::Allocate(size, alignof(std::max_align_t));
+}
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return alloc_tracking::Allocate(size, static_cast< std::size_t >(alignment));
+}
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return alloc_tracking::Allocate(size, static_cast< std::size_t >(alignment));
+}
+
+void operator delete(void* ptr) noexcept {
+    alloc_tracking::Deallocate(ptr);
+}
+void operator delete[](void* ptr) noexcept {
+    alloc_tracking::Deallocate(ptr);
+}
+void operator delete(void* ptr, std::size_t) noexcept {
+    alloc_tracking::Deallocate(ptr);
+}
+void operator delete[](void* ptr, std::size_t) noexcept {
+    alloc_tracking::Deallocate(ptr);
+}
+void operator delete(void* ptr, std::align_val_t) noexcept {
+    alloc_tracking::Deallocate(ptr);
+}
+void operator delete[](void* ptr, std::align_val_t) noexcept {
+    alloc_tracking::Deallocate(ptr);
+}
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept {
+    alloc_tracking::Deallocate(ptr);
+}
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept {
+    alloc_tracking::Deallocate(ptr);
+}
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+    alloc_tracking::Deallocate(ptr);
+}
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+    alloc_tracking::Deallocate(ptr);
+}
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept {
+    alloc_tracking::Deallocate(ptr);
+}
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept {
+    alloc_tracking::Deallocate(ptr);
+}
+
+#endif // ALLOCATION_TRACKING
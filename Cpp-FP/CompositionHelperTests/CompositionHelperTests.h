@@ -11,7 +11,11 @@
 #include <LinqContainer.hpp>
 #include <array>
 #include <cassert>
+#include <cstddef>
+#include <functional>
 #include <limits>
+#include <span>
+#include <stdexcept>
 #include <utility>
 
 #define EXPECTED_RESULT(type, count_, ...)                     \
@@ -66,6 +70,51 @@ void test_free_compose() {
     my_data.Select(F).ForEach(CHECK_RESULT(double, element));
 }
 
+void test_static_compose() {
+    auto my_data = fp::LinqContainer< std::pair< double, double > > { { 3, 1 }, { 5, 1 }, { 7, 1 }, { 8, 1 } };
+    EXPECTED_RESULT(double, 4, 6, 26, 54, 71)
+
+    // No function pointer is stored, the composition is a chain of direct calls
+    auto F = fp::Compose(fp::StaticFunction< &add > {}, fp::StaticFunction< &square > {}).Compose(fp::StaticFunction< &subtract_ten > {});
+    static_assert(sizeof(F) < sizeof(double (*)(double)));
+    static_assert(noexcept(F(std::declval< std::pair< double, double > >())));
+
+    my_data.Select(F).ForEach(CHECK_RESULT(double, element));
+}
+
+template < class... Callables >
+concept pipeable = requires(Callables... callables) { fp::Pipe(callables...); };
+
+void test_pipe() {
+    auto my_data = fp::LinqContainer< int > { 3, 5, 7, 8 };
+    EXPECTED_RESULT(double, 4, 6, 26, 54, 71)
+
+    auto F = fp::Pipe(lambda_add_one, lambda_int_to_double, lambda_square, lambda_subtract_ten);
+    my_data.Select(F).ForEach(CHECK_RESULT(double, element));
+
+    // Flat: the pipe is exactly as big as its stages
+    auto G = fp::Pipe(&add, &square, &subtract_ten);
+    auto H = fp::Compose(&add, &square).Compose(&subtract_ten);
+    static_assert(sizeof(G) == 3 * sizeof(double (*)(double)));
+    static_assert(noexcept(G(std::declval< std::pair< double, double > >())));
+    static_assert(sizeof(fp::Pipe(fp::StaticFunction< &add > {}, fp::StaticFunction< &square > {}, fp::StaticFunction< &subtract_ten > {})) <= 3);
+    assert(G({ 3, 1 }) == 6 && H({ 3, 1 }) == 6);
+
+    // Pipes compose with everything else, and run stage by stage in a batch
+    auto I = fp::Pipe(fp::Compose(lambda_add_one, lambda_int_to_double), lambda_square).Compose(lambda_subtract_ten);
+    assert(I(3) == 6);
+    std::array< int, 600 > input {};
+    for (auto i = 0; i < static_cast< int >(input.size()); ++i) { input[i] = i; }
+    std::array< double, 600 > output {};
+    F.Apply(std::span< const int > { input }, std::span< double > { output });
+    for (std::size_t i = 0; i < input.size(); ++i) { assert(output[i] == F(input[i]) && output[i] == I(input[i])); }
+
+    // Stages are checked with fp::composable
+    static_assert(pipeable< decltype(lambda_add_one), decltype(lambda_int_to_double), decltype(lambda_square) >);
+    static_assert(!pipeable< decltype(lambda_add_one), decltype(lambda_square) >);
+    static_assert(!pipeable<>);
+}
+
 enum class IngredientType : std::uint8_t {
     Flour = 1,
     Salad = 2,
@@ -110,6 +159,113 @@ void test_combination() {
     my_data.Select(F).ForEach(CHECK_RESULT(Weight, element.weight));
 }
 
+static int stage_calls[2] {};
+static int stage_order_violations = 0;
+
+void test_batch_apply() {
+    auto first  = [](int x) noexcept {
+        ++stage_calls[0];
+        return x + 1;
+    };
+    auto second = [](int x) noexcept {
+        // Staged: the first stage has run over the whole block before the second stage starts
+        if (stage_calls[0] % static_cast< int >(fp::batch_block_size) != 0 && stage_calls[0] != 1000) ++stage_order_violations;
+        ++stage_calls[1];
+        return static_cast< double >(x) * 2.;
+    };
+    auto F = fp::Compose(fp::Compose(first, second), lambda_square).Compose(lambda_subtract_ten);
+
+    std::array< int, 1000 > input {};
+    for (auto i = 0; i < static_cast< int >(input.size()); ++i) { input[i] = i - 500; }
+    std::array< double, 1000 > staged {};
+    std::array< double, 1000 > fused {};
+
+    F.Apply(std::span< const int > { input }, std::span< double > { staged });
+    assert(stage_calls[0] == 1000 && stage_calls[1] == 1000 && stage_order_violations == 0);
+    F.Apply(std::span< const int > { input }, std::span< double > { fused }, fp::BatchMode::Fused);
+    for (std::size_t i = 0; i < input.size(); ++i) { assert(staged[i] == F(input[i]) && fused[i] == staged[i]); }
+
+    // Stages with a non-const call operator, a function pointer first stage
+    auto G          = fp::CompositionFunction< decltype(calcCost) > { calcCost }.Compose(Buyer {}).Compose(lambda_cook_food).Compose(Scale {});
+    auto ingredients = std::array< Ingredient, 3 > { Ingredient { IngredientType::Flour }, Ingredient { IngredientType::Salad }, Ingredient { IngredientType::Meat } };
+    std::array< Weight, 3 > weights {};
+    G.Apply(std::span< const Ingredient > { ingredients }, std::span< Weight > { weights });
+    assert(weights[0].weight == 150 && weights[1].weight == 50 && weights[2].weight == 150);
+
+    auto thrown = false;
+    try {
+        G.Apply(std::span< const Ingredient > { ingredients }, std::span< Weight > { weights }.first(2));
+    } catch (const std::invalid_argument&) { thrown = true; }
+    assert(thrown);
+}
+
+// A heavy stateful stage that counts how often it is copied
+struct RuleTable {
+    inline static int copies = 0;
+
+    std::array< int, 64 > offsets {};
+    int                   calls = 0;
+
+    RuleTable() = default;
+    RuleTable(const RuleTable& other) : offsets(other.offsets), calls(other.calls) { ++copies; }
+    RuleTable(RuleTable&&) noexcept = default;
+    RuleTable& operator=(const RuleTable& other) {
+        offsets = other.offsets;
+        calls   = other.calls;
+        ++copies;
+        return *this;
+    }
+    RuleTable& operator=(RuleTable&&) noexcept = default;
+
+    int operator()(int x) {
+        ++calls;
+        return x + offsets[static_cast< std::size_t >(x) % offsets.size()];
+    }
+};
+
+// An argument that counts how often it is copied
+struct Payload {
+    inline static int copies = 0;
+
+    int value = 0;
+
+    Payload() = default;
+    explicit Payload(int value_) : value(value_) {}
+    Payload(const Payload& other) : value(other.value) { ++copies; }
+    Payload(Payload&&) noexcept = default;
+};
+
+void test_move_aware_compose() {
+    RuleTable::copies = 0;
+
+    // Rvalue stages are moved all along the chain
+    auto table = RuleTable {};
+    table.offsets.fill(1);
+    auto F = fp::Compose(RuleTable { table }, RuleTable { table }).Compose(RuleTable { table }).Compose(RuleTable { table });
+    assert(RuleTable::copies == 4);
+    assert(F(0) == 4);
+
+    // Borrowed stages are neither copied nor moved, and see the state of the original
+    RuleTable::copies = 0;
+    auto G            = fp::Compose(std::ref(table), std::ref(table)).Compose(std::ref(table));
+    assert(G(0) == 3 && table.calls == 3 && RuleTable::copies == 0);
+    auto H = fp::Compose(lambda_add_one, std::cref(lambda_add_one));
+    assert(H(1) == 3);
+
+    // An lvalue composition is copied, composing it again leaves it usable
+    RuleTable::copies = 0;
+    auto I            = F.Compose(lambda_int_to_double);
+    assert(RuleTable::copies == 4 && F(0) == 4 && I(0) == 4.);
+
+    // Arguments are forwarded from stage to stage, only the first parameter takes a copy
+    Payload::copies = 0;
+    auto unwrap     = [](Payload p) noexcept { return Payload { p.value + 1 }; };
+    auto J          = fp::Compose(unwrap, unwrap).Compose(unwrap).Compose([](Payload p) noexcept { return p.value; });
+    const Payload payload { 1 };
+    assert(J(payload) == 4 && Payload::copies == 1);
+    assert(J(Payload { 1 }) == 4 && Payload::copies == 1);
+}
+
 // Traits
 static_assert(std::is_nothrow_invocable_v< decltype(fp::CompositionFunction< decltype(add) > { add }.Compose(square)), std::pair< double, double > >);
 static_assert(!std::is_nothrow_invocable_v< decltype(fp::CompositionFunction< decltype(calcCost) > { calcCost }.Compose(Buyer {})), Ingredient >);
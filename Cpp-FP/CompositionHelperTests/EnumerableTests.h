@@ -0,0 +1,127 @@
+﻿// EnumerableTests.h
+// This contains unit tests to the implementation in LINQ_CPP.hpp
+
+#ifndef ENUMERABLE_TESTS
+#define ENUMERABLE_TESTS
+
+#include "CompositionHelperTests.h"
+#include <LINQ_CPP.hpp>
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+#include <filesystem>
+#include <limits>
+#include <numeric>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+void test_enumerable_select() {
+    linq::Enumerable numbers { 1, 2, 3, 4 };
+
+    auto squares = numbers.Select([](int x) { return static_cast< double >(x) * x; }).Select([](double x, std::size_t index) { return x + index; });
+    static_assert(std::is_same_v< decltype(squares)::value_type, double >);
+
+    auto enumerator = squares.GetEnumerator();
+    EXPECTED_RESULT(double, 4, 1., 5., 11., 19.)
+    while (enumerator.MoveNext()) { CHECK_RESULT(double, element)(enumerator.Current()); }
+    assert(count == 4);
+
+    assert(squares.Aggregate(0., [](double total, double next) { return total + next; }) == 36.);
+    // Enumerables are not consumed by a query
+    assert(squares.Aggregate([](double total, double next) { return total + next; }) == 36.);
+    assert(numbers.Aggregate(
+               std::string {}, [](std::string text, int next) { return text + std::to_string(next); }, [](const std::string& text) { return text.size(); }) == 4);
+
+    // Opt-in type-erased boundary
+    auto                      erased           = numbers.Select([](int x) { return x * 10; }).AsIEnumerable();
+    linq::IEnumerable< int >& enumerable       = erased;
+    auto                      erasedEnumerator = enumerable.GetEnumerator();
+    auto                      sum              = 0;
+    while (erasedEnumerator->MoveNext()) { sum += erasedEnumerator->Current(); }
+    assert(sum == 100);
+}
+
+struct OrderRecord {
+    std::uint32_t id;
+    double        amount;
+};
+
+void test_enumerable_sources() {
+    auto sum = [](auto total, auto next) { return total + next; };
+
+    // Adopted vector and borrowed span/iterator pair share the caller's elements
+    auto values  = std::vector< int > { 1, 2, 3, 4 };
+    auto adopted = linq::Enumerable(std::vector< int > { 5, 6 });
+    auto spanned = linq::Enumerable(std::span { values });
+    auto ranged  = linq::Enumerable(values.begin() + 1, values.end());
+    assert(adopted.Aggregate(0, sum) == 11);
+    assert(spanned.Select([](int x) { return x * 2; }).Aggregate(0, sum) == 20);
+    assert(ranged.size() == 3 && ranged.Aggregate(0, sum) == 9);
+    values[0] = 10;
+    assert(spanned.Aggregate(0, sum) == 19);
+
+    // Memory mapped dump of trivially copyable records
+    const auto path    = std::filesystem::temp_directory_path() / "fp_enumerable_records.bin";
+    const auto records = std::vector< OrderRecord > { { 1, 10.5 }, { 2, 20. }, { 3, 30.25 } };
+    if (auto* file = std::fopen(path.string().c_str(), "wb")) {
+        std::fwrite(records.data(), sizeof(OrderRecord), records.size(), file);
+        std::fclose(file);
+    }
+    {
+        auto mapped = linq::Enumerable< OrderRecord >::FromFile(path);
+        assert(mapped.size() == 3);
+        assert(mapped.Select([](const OrderRecord& record) { return record.amount; }).Aggregate(0., sum) == 60.75);
+    }
+    std::filesystem::remove(path);
+}
+
+void test_enumerable_reductions() {
+    auto values = std::vector< int >(100'003);
+    std::iota(values.begin(), values.end(), -50'000);
+    const auto numbers = linq::Enumerable(std::span { values });
+    const auto policy  = fp::execution::parallel_policy { 1000 };
+
+    assert(numbers.Sum() == 100'003 && numbers.Sum(policy) == numbers.Sum());
+    assert(numbers.Min() == -50'000 && numbers.Min(policy) == -50'000);
+    assert(numbers.Max() == 50'002 && numbers.Max(policy) == 50'002);
+    assert(numbers.Average() == 1. && numbers.Average(policy) == 1.);
+    assert(numbers.Count() == values.size());
+    assert(numbers.Count([](int x) { return x % 2 == 0; }) == 50'002 && numbers.Count(policy, [](int x) { return x % 2 == 0; }) == 50'002);
+
+    // Integer sums are widened and integer averages are not truncated
+    const auto large = linq::Enumerable { std::numeric_limits< int >::max(), std::numeric_limits< int >::max(), 1 };
+    assert(large.Sum() == 2LL * std::numeric_limits< int >::max() + 1);
+    const auto halves = linq::Enumerable { 1, 2 };
+    assert(halves.Average() == 1.5);
+
+    // Selected values are reduced block by block
+    const auto squares = numbers.Select([](int x) { return static_cast< std::int64_t >(x) * x; });
+    assert(squares.Sum(policy) == squares.Aggregate(std::int64_t { 0 }, [](std::int64_t total, std::int64_t next) { return total + next; }));
+    assert(squares.Max(policy) == 50'002LL * 50'002 && squares.Min() == 0);
+
+    // Floating point sums are compensated between blocks, a plain running sum is off by about 0.4 here
+    auto tenths = std::vector< double >(1'000'000, 0.1);
+    tenths.front() = 1e10;
+    const auto doubles = linq::Enumerable(std::span { tenths });
+    assert(std::abs(doubles.Sum() - (1e10 + 99'999.9)) < 1e-2 && std::abs(doubles.Sum(policy) - (1e10 + 99'999.9)) < 1e-2);
+
+    // Parallel fold with an associative merge
+    auto sum = [](std::int64_t total, std::int64_t next) { return total + next; };
+    assert(numbers.Aggregate(policy, std::int64_t { 0 }, sum, sum) == 100'003);
+    assert(numbers.Aggregate(fp::execution::seq, std::int64_t { 0 }, sum, sum) == 100'003);
+
+    const auto empty = linq::Enumerable(std::vector< int > {});
+    assert(empty.Sum() == 0 && empty.Sum(policy) == 0 && empty.Count() == 0);
+    auto throws = [](auto reduce) {
+        try {
+            static_cast< void >(reduce());
+        } catch (const std::out_of_range&) { return true; }
+        return false;
+    };
+    assert(throws([&] { return empty.Average(); }) && throws([&] { return empty.Min(policy); }) && throws([&] { return empty.Max(); }));
+}
+
+#endif // ENUMERABLE_TESTS
@@ -0,0 +1,125 @@
+﻿// FPUtilityTests.h
+// This contains unit tests to the allocation helpers in FPUtility.hpp
+
+#ifndef FP_UTILITY_TESTS
+#define FP_UTILITY_TESTS
+
+#include <FPUtility.hpp>
+#include <LINQ_CPP.hpp>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+
+namespace utility_tests {
+    // Stateful allocator counting what it hands out through a shared counter
+    template < class Type >
+    struct CountingAllocator {
+        using value_type = Type;
+
+        explicit CountingAllocator(int* live_) noexcept : live(live_) {}
+        template < class Other >
+        CountingAllocator(const CountingAllocator< Other >& other) noexcept : live(other.live) {}
+
+        Type* allocate(std::size_t n) {
+            ++*live;
+            return std::allocator< Type > {}.allocate(n);
+        }
+        void deallocate(Type* ptr, std::size_t n) noexcept {
+            --*live;
+            std::allocator< Type > {}.deallocate(ptr, n);
+        }
+
+        template < class Other >
+        bool operator==(const CountingAllocator< Other >& other) const noexcept {
+            return live == other.live;
+        }
+
+        int* live;
+    };
+
+    struct Base {
+        virtual ~Base() = default;
+        virtual int Value() const noexcept { return 0; }
+    };
+
+    struct Derived final : Base {
+        Derived(int value_, int* destroyed_) : value(value_), destroyed(destroyed_) {}
+        ~Derived() override { ++*destroyed; }
+        int Value() const noexcept override { return value; }
+
+        int  value;
+        int* destroyed;
+    };
+
+    struct ThrowsOnThird {
+        ThrowsOnThird() {
+            if (++constructed == 3) throw std::runtime_error { "third" };
+        }
+        ~ThrowsOnThird() { ++destroyed; }
+
+        static inline int constructed = 0;
+        static inline int destroyed   = 0;
+    };
+} // namespace utility_tests
+
+void test_allocate_unique() {
+    using namespace utility_tests;
+
+    // Stateless allocators cost nothing, the deleter is a direct call
+    auto owned = fp::allocate_unique< int >(std::allocator< int > {}, 5);
+    static_assert(sizeof(owned) == sizeof(int*));
+    assert(*owned == 5);
+    auto array = fp::allocate_unique< int[] >(std::allocator< int > {}, 4);
+    array[3]   = 1;
+    assert(array[3] == 1);
+
+    // Stateful allocators are kept by the deleter and free what they allocated
+    int live = 0;
+    {
+        auto counted = fp::allocate_unique< int >(CountingAllocator< char > { &live }, 7);
+        assert(live == 1 && *counted == 7 && counted.get_deleter().get_allocator().live == &live);
+    }
+    assert(live == 0);
+
+    // Owned through the base, destroyed and deallocated as the derived type
+    int destroyed = 0;
+    {
+        auto derived = fp::allocate_unique< Base, Derived >(CountingAllocator< Base > { &live }, 3, &destroyed);
+        assert(live == 1 && derived->Value() == 3);
+    }
+    assert(live == 0 && destroyed == 1);
+
+    // A throwing element constructor unwinds the elements already built and frees the array
+    try {
+        auto failed = fp::allocate_unique< ThrowsOnThird[] >(CountingAllocator< ThrowsOnThird > { &live }, 5);
+        assert(false);
+    } catch (const std::runtime_error&) {}
+    assert(live == 0 && ThrowsOnThird::constructed == 3 && ThrowsOnThird::destroyed == 2);
+
+    // Pooled nodes are recycled for the next object of the same size class
+    destroyed  = 0;
+    auto first = fp::allocate_pooled< Base, Derived >(1, &destroyed);
+    static_assert(sizeof(first) == sizeof(Base*));
+    const void* node = first.get();
+    first.reset();
+    assert(destroyed == 1);
+    std::unique_ptr< Base, fp::PooledDeleter< Base > > second = fp::allocate_pooled< Derived >(2, &destroyed);
+    assert(second.get() == node && second->Value() == 2);
+    second.reset();
+    assert(destroyed == 2);
+
+    // Type-erased enumerators reuse the node of the previous query
+    auto                      erased     = linq::Enumerable { 1, 2, 3 }.AsIEnumerable();
+    linq::IEnumerable< int >& enumerable = erased;
+    auto                      enumerator = enumerable.GetEnumerator();
+    const void*               previous   = enumerator.get();
+    enumerator.reset();
+    enumerator = enumerable.GetEnumerator();
+    assert(enumerator.get() == previous);
+    auto sum = 0;
+    while (enumerator->MoveNext()) { sum += enumerator->Current(); }
+    assert(sum == 6);
+}
+
+#endif // FP_UTILITY_TESTS
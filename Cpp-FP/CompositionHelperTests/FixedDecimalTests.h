@@ -0,0 +1,81 @@
+﻿// FixedDecimalTests.h
+// This contains unit tests to the implementation in FixedDecimal.hpp
+
+#ifndef FIXED_DECIMAL_TESTS
+#define FIXED_DECIMAL_TESTS
+
+#include <FixedDecimal.hpp>
+#include <LinqContainer.hpp>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+void test_fixed_decimal() {
+    using Money = fp::FixedDecimal< 4 >;
+    using fp::RoundingMode;
+
+    static_assert(sizeof(Money) == sizeof(std::int64_t) && std::is_trivially_copyable_v< Money >);
+
+    assert((Money { 10 } / Money { 3 }).ToString() == "3.3333");
+    assert((-Money { 2 } / Money { 3 }).ToString() == "-0.6667");
+    assert(Money::Divide(Money { 2 }, Money { 3 }, RoundingMode::TowardZero).ToString() == "0.6666");
+    assert(Money::Divide(-Money { 2 }, Money { 3 }, RoundingMode::Down).ToString() == "-0.6667");
+    assert(Money::Divide(-Money { 2 }, Money { 3 }, RoundingMode::Up).ToString() == "-0.6666");
+    assert(Money { 1.5 } * Money { 1.5 } == Money { 2.25 });
+    assert(Money::FromUnits(-5).ToString() == "-0.0005" && Money {}.ToString() == "0.0000");
+    assert(static_cast< double >(Money { 1.25 }) == 1.25);
+
+    // Ties
+    assert(Money::FromUnits(250).Rescale< 2 >().ToString() == "0.02");
+    assert(Money::FromUnits(350).Rescale< 2 >().ToString() == "0.04");
+    assert(Money::FromUnits(250).Rescale< 2 >(RoundingMode::HalfAwayFromZero).ToString() == "0.03");
+    assert(Money::FromUnits(-250).Rescale< 2 >(RoundingMode::HalfAwayFromZero).ToString() == "-0.03");
+    assert(fp::FixedDecimal< 2 > { 0.125 }.ToString() == "0.12");
+    assert(fp::FixedDecimal< 2 >::FromFloating(0.125, RoundingMode::HalfAwayFromZero).ToString() == "0.13");
+
+    auto thrown = false;
+    try {
+        (void)(Money { 1 } / Money { 0 });
+    } catch (const std::domain_error&) { thrown = true; }
+    assert(thrown);
+    thrown = false;
+    try {
+        (void)(Money::FromUnits(std::numeric_limits< std::int64_t >::max()) + Money::FromUnits(1));
+    } catch (const std::overflow_error&) { thrown = true; }
+    assert(thrown);
+
+    // LinqContainer averages use the decimal arithmetic
+    const fp::LinqContainer< Money > discounts { Money { 10 }, Money { 5 }, Money { 2 }, Money { 3 } };
+    assert(discounts.Average().ToString() == "5.0000");
+    assert(discounts.Average(fp::execution::par) == discounts.Average());
+
+    // Batched kernels are exact, including sums whose lanes cross 32 bits boundaries
+    std::vector< Money > column {};
+    std::int64_t         expected = 0;
+    for (std::int64_t i = 0; i < 10007; ++i) {
+        column.push_back(Money::FromUnits(i * 1000003 - 4000000000LL));
+        expected += column.back().Units();
+    }
+    assert(fp::decimal_kernels::Sum(std::span< const Money > { column }).Units() == expected);
+    assert(fp::decimal_kernels::Average(std::span< const Money > { column }) == Money::Divide(Money::FromUnits(expected), column.size(), RoundingMode::HalfEven));
+
+    std::vector< Money > doubled(column.size());
+    fp::decimal_kernels::Add(std::span< const Money > { column }, std::span< const Money > { column }, std::span< Money > { doubled });
+    assert(doubled[5] == column[5] + column[5]);
+
+    const std::vector< Money > large(5, Money::FromUnits(std::numeric_limits< std::int64_t >::max() / 4));
+    thrown = false;
+    try {
+        (void)fp::decimal_kernels::Sum(std::span< const Money > { large });
+    } catch (const std::overflow_error&) { thrown = true; }
+    assert(thrown);
+
+    using Cents = fp::FixedDecimal< 2, std::int32_t >;
+    const std::vector< Cents > cents(100, Cents { 1.5 });
+    assert(fp::decimal_kernels::Sum(std::span< const Cents > { cents }) == Cents { 150 });
+}
+
+#endif // FIXED_DECIMAL_TESTS
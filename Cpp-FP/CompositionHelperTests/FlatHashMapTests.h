@@ -0,0 +1,158 @@
+﻿// FlatHashMapTests.h
+// This contains unit tests to the implementation in FlatHashMap.hpp and the LinqContainer hash operators
+
+#ifndef FLAT_HASH_MAP_TESTS
+#define FLAT_HASH_MAP_TESTS
+
+#include <FlatHashMap.hpp>
+#include <LinqContainer.hpp>
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace hash_tests {
+    struct Customer {
+        int         id;
+        std::string name;
+    };
+
+    struct Sale {
+        int    customer;
+        double amount;
+    };
+
+    struct Line {
+        std::string customer;
+        double      amount = 0;
+    };
+
+    // Large enough to take the partitioned paths with a small grain
+    inline std::vector< Sale > MakeSales(std::size_t count, int customers) {
+        std::vector< Sale > sales;
+        sales.reserve(count);
+        for (std::size_t i = 0; i < count; ++i) { sales.push_back({ static_cast< int >((i * 7919) % customers) * 1024, static_cast< double >(i % 100) }); }
+        return sales;
+    }
+} // namespace hash_tests
+
+void test_flat_hash_map() {
+    fp::FlatHashMap< std::string, int > counts {};
+    assert(counts.TryAdd("ruby", 1) && counts.TryAdd("navy", 2) && !counts.TryAdd("ruby", 3));
+    assert(counts.size() == 2 && counts.at("ruby") == 1 && counts.Find("cherry") == nullptr && counts.FindOrDefault("cherry") == 0);
+    ++counts["cherry"];
+    ++counts["ruby"];
+    assert(counts.at("cherry") == 1 && counts.at("ruby") == 2 && counts.contains("navy"));
+
+    // Iterated in insertion order
+    auto keys = std::vector< std::string > {};
+    for (const auto& [key, value] : counts) { keys.push_back(key); }
+    assert((keys == std::vector< std::string > { "ruby", "navy", "cherry" }));
+
+    auto thrown = false;
+    try {
+        (void)counts.at("amber");
+    } catch (const std::out_of_range&) { thrown = true; }
+    assert(thrown);
+
+    // Keys that differ only in their high bits still spread over the table
+    fp::FlatHashMap< std::size_t, std::size_t > strided {};
+    for (std::size_t i = 0; i < 20'000; ++i) { assert(strided.TryAdd(i << 20, i)); }
+    for (std::size_t i = 0; i < 20'000; ++i) { assert(strided.at(i << 20) == i); }
+    assert(strided.size() == 20'000 && !strided.contains(1));
+
+    // One-to-many: keys in order of first appearance, values contiguous and in source order
+    const auto words  = std::vector< std::string > { "kiwi", "fig", "pear", "plum", "lime", "yam" };
+    const auto length = [](const std::string& word) { return word.size(); };
+    const auto lookup = fp::FlatLookup< std::size_t, std::string >(words, length, std::identity {});
+    assert(lookup.GroupCount() == 2 && lookup.size() == 6 && lookup.Keys()[0] == 4 && lookup.Keys()[1] == 3);
+    assert(std::ranges::equal(lookup[4], std::vector< std::string > { "kiwi", "pear", "plum", "lime" }));
+    assert(lookup.at(3).size() == 2 && lookup[5].empty() && lookup.IndexOf(5) == lookup.npos);
+
+    // The partitioned build gives the same lookup
+    const auto sales       = hash_tests::MakeSales(50'000, 997);
+    const auto customer    = [](const hash_tests::Sale& sale) { return sale.customer; };
+    const auto amount      = [](const hash_tests::Sale& sale) { return sale.amount; };
+    const auto sequential  = fp::FlatLookup< int, double >(sales, customer, amount);
+    const auto partitioned = fp::FlatLookup< int, double >(fp::execution::parallel_policy { 1000 }, sales, customer, amount);
+    assert(sequential.GroupCount() == 997 && partitioned.GroupCount() == 997);
+    assert(std::ranges::equal(sequential.Keys(), partitioned.Keys()));
+    for (const auto key : sequential.Keys()) { assert(std::ranges::equal(sequential[key], partitioned[key])); }
+}
+
+void test_hash_operators() {
+    using hash_tests::Customer;
+    using hash_tests::Line;
+    using hash_tests::Sale;
+
+    const fp::LinqContainer< Customer > customers { { 1, "ada" }, { 2, "bob" }, { 3, "cy" } };
+    const fp::LinqContainer< Sale >     sales { { 2, 10. }, { 1, 5. }, { 2, 7. }, { 4, 1. }, { 1, 3. } };
+
+    // Groups in order of first appearance, elements in source order
+    const auto byCustomer = sales.GroupBy(&Sale::customer, &Sale::amount);
+    assert(byCustomer.size() == 3 && byCustomer.at(0).key == 2 && byCustomer.at(1).key == 1 && byCustomer.at(2).key == 4);
+    assert(byCustomer.at(0).elements.size() == 2 && byCustomer.at(0).elements.at(1) == 7.);
+    assert(byCustomer.at(1).elements.Average() == 4.);
+
+    // Inner join keeps the order of the outer container, then of the inner one
+    const auto lines = sales.Join(customers, &Sale::customer, &Customer::id, [](const Sale& sale, const Customer& customer_) {
+        return Line { customer_.name, sale.amount };
+    });
+    assert(lines.size() == 4 && lines.at(0).customer == "bob" && lines.at(1).customer == "ada" && lines.at(3).amount == 3.);
+
+    // Group join yields one result per outer element, with no matches for customers without sales
+    const auto totals = customers.GroupJoin(sales, &Customer::id, &Sale::customer, [](const Customer&, std::span< const Sale > matches) {
+        auto total = 0.;
+        for (const auto& sale : matches) { total += sale.amount; }
+        return total;
+    });
+    assert(totals.size() == 3 && totals.at(0) == 8. && totals.at(1) == 17. && totals.at(2) == 0.);
+
+    const auto distinct = fp::LinqContainer< int > { 3, 1, 3, 2, 1, 3 }.Distinct();
+    assert((std::ranges::equal(distinct, std::vector< int > { 3, 1, 2 })));
+    assert(sales.DistinctBy(&Sale::customer).size() == 3);
+
+    // Unique keys for the hashed dictionary
+    const auto byName = customers.ToDictionary(&Customer::name, &Customer::id);
+    assert(byName.at("cy") == 3 && !byName.contains("dee"));
+
+    // Partitioned parallel builds agree with the sequential ones
+    const auto many   = fp::LinqContainer< Sale > { hash_tests::MakeSales(60'000, 1009) };
+    const auto policy = fp::execution::parallel_policy { 1000 };
+
+    const auto groups         = many.GroupBy(&Sale::customer, &Sale::amount);
+    const auto parallelGroups = many.GroupBy(policy, &Sale::customer, &Sale::amount);
+    assert(groups.size() == 1009 && parallelGroups.size() == 1009);
+    for (std::size_t i = 0; i < groups.size(); ++i) {
+        assert(groups.at(i).key == parallelGroups.at(i).key);
+        assert(std::ranges::equal(groups.at(i).elements, parallelGroups.at(i).elements));
+    }
+
+    auto ids = std::vector< Customer > {};
+    for (int id = 0; id < 1009 * 1024; id += 2048) { ids.push_back({ id, std::to_string(id) }); }
+    const auto accounts = fp::LinqContainer< Customer > { ids };
+    const auto tag      = [](const Sale& sale, const Customer& customer_) { return sale.amount + customer_.id; };
+    const auto joined   = many.Join(accounts, &Sale::customer, &Customer::id, tag);
+    assert(std::ranges::equal(joined, many.Join(policy, accounts, &Sale::customer, &Customer::id, tag)));
+    assert(joined.size() == static_cast< std::size_t >(std::ranges::count_if(many, [](const Sale& sale) { return sale.customer % 2048 == 0; })));
+
+    const auto counted = [](const Customer&, std::span< const Sale > matches) { return matches.size(); };
+    assert(std::ranges::equal(accounts.GroupJoin(many, &Customer::id, &Sale::customer, counted),
+                              accounts.GroupJoin(policy, many, &Customer::id, &Sale::customer, counted)));
+
+    const auto firstSales = many.DistinctBy(&Sale::customer);
+    assert(firstSales.size() == 1009);
+    assert(std::ranges::equal(firstSales, many.DistinctBy(policy, &Sale::customer),
+                              [](const Sale& a, const Sale& b) { return a.customer == b.customer && a.amount == b.amount; }));
+    const auto amounts = many.Select([](const Sale& sale) { return sale.amount; });
+    assert(std::ranges::equal(amounts.Distinct(), amounts.Distinct(policy)) && amounts.Distinct().size() == 100);
+
+    const auto lookup = many.ToLookup(policy, &Sale::customer, &Sale::amount);
+    assert(lookup.GroupCount() == 1009 && std::ranges::equal(lookup[groups.at(1).key], groups.at(1).elements));
+}
+
+#endif // FLAT_HASH_MAP_TESTS
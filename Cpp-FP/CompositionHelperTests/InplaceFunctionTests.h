@@ -0,0 +1,60 @@
+﻿// InplaceFunctionTests.h
+// This contains unit tests to the implementation in InplaceFunction.hpp
+
+#ifndef INPLACE_FUNCTION_TESTS
+#define INPLACE_FUNCTION_TESTS
+
+#include <InplaceFunction.hpp>
+#include <cassert>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+void test_inplace_function() {
+    using Function        = fp::InplaceFunction< int(int) >;
+    using NothrowFunction = fp::InplaceFunction< int(int) noexcept >;
+
+    static_assert(!std::is_copy_constructible_v< Function >);
+    static_assert(std::is_nothrow_move_constructible_v< Function >);
+    static_assert(!std::is_nothrow_invocable_v< const Function&, int >);
+    static_assert(std::is_nothrow_invocable_v< const NothrowFunction&, int >);
+    // A noexcept signature rejects callables that may throw
+    static_assert(!std::is_constructible_v< NothrowFunction, int (*)(int) >);
+    static_assert(std::is_constructible_v< NothrowFunction, int (*)(int) noexcept >);
+
+    Function empty {};
+    assert(!empty);
+    auto thrown = false;
+    try {
+        empty(1);
+    } catch (const std::bad_function_call&) { thrown = true; }
+    assert(thrown);
+
+    // Captured state lives in the inline buffer and is moved, never copied
+    auto     counter = std::make_unique< int >(0);
+    Function add { [state = std::move(counter)](int value) { return *state += value; } };
+    assert(add(2) == 2 && add(3) == 5);
+
+    Function moved { std::move(add) };
+    assert(!add && moved && moved(1) == 6);
+
+    add = std::move(moved);
+    assert(add(1) == 7);
+    add = nullptr;
+    assert(!add);
+
+    NothrowFunction twice { [](int value) noexcept { return value * 2; } };
+    assert(twice(21) == 42);
+
+    // target() recognizes the stored callable type without RTTI
+    struct Constant {
+        int value;
+        int operator()(int) const { return value; }
+    };
+    Function constant { Constant { 7 } };
+    assert(constant.target< Constant >() != nullptr && constant.target< Constant >()->value == 7);
+    assert(twice.target< Constant >() == nullptr);
+}
+
+#endif // INPLACE_FUNCTION_TESTS
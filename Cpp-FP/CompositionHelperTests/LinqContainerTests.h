@@ -0,0 +1,146 @@
+﻿// LinqContainerTests.h
+// This contains unit tests to the implementation in LinqContainer.hpp
+
+#ifndef LINQ_CONTAINER_TESTS
+#define LINQ_CONTAINER_TESTS
+
+#include "CompositionHelperTests.h"
+#include <ArenaAllocator.hpp>
+#include <LinqContainer.hpp>
+#include <StreamSource.hpp>
+#include <cassert>
+#include <cstdio>
+#include <filesystem>
+#include <optional>
+#include <atomic>
+#include <functional>
+#include <memory_resource>
+#include <numeric>
+#include <vector>
+
+void test_lazy_pipeline() {
+    auto my_data = fp::LinqContainer< int > { 9, 4, 7, 1, 8, 2, 6 };
+    EXPECTED_RESULT(double, 3, 4., 16., 36.)
+
+    my_data.AsLazy()
+        .Where([](int x) { return x % 2 == 0; })
+        .OrderBy(std::less {})
+        .Take(3)
+        .Select([](int x) { return static_cast< double >(x) * x; })
+        .ForEach(CHECK_RESULT(double, element));
+    assert(count == 3);
+
+    assert(my_data.AsLazy().Where([](int x) { return x > 5; }).FirstOrDefault() == 9);
+    assert(my_data.AsLazy().Where([](int x) { return x > 100; }).FirstOrDefault() == 0);
+    assert(my_data.AsLazy().Select([](int x) { return static_cast< double >(x); }).Take(2).Average() == 6.5);
+
+    auto lazy = my_data.AsLazy().Where([](int x) { return x < 5; });
+    assert((lazy.ToVector() == std::vector< int > { 4, 1, 2 }));
+    assert((lazy.OrderBy(std::greater {}).ToVector() == std::vector< int > { 4, 2, 1 }));
+    assert(lazy.Take(0).ToVector().empty());
+
+    auto owned = fp::LinqContainer< int > { 3, 5 }.AsLazy().Select([](int x) { return x * 2; }).ToVector();
+    assert((owned == std::vector< int > { 6, 10 }));
+}
+
+void test_take_ordered() {
+    const auto my_data = fp::LinqContainer< int > { 9, 4, 7, 1, 8, 2, 6, 4 };
+    EXPECTED_RESULT(int, 3, 1, 2, 4)
+
+    my_data.TakeOrdered(3, std::less {}).ForEach(CHECK_RESULT(int, element));
+    assert((fp::LinqContainer< int > { 5, 3 }.TakeOrdered(10, std::greater {}).FirstOrDefault() == 5));
+    assert((fp::LinqContainer< int > { 5, 3, 8 }.TakeOrdered(2, std::greater {}).Average() == 6.5));
+
+    // OrderBy(...).Take(n) is fused into a bounded heap in lazy mode
+    assert((my_data.AsLazy().OrderBy(std::less {}).Take(3).ToVector() == std::vector< int > { 1, 2, 4 }));
+    assert((my_data.AsLazy().OrderBy(std::greater {}).Take(4).Take(2).ToVector() == std::vector< int > { 9, 8 }));
+    assert((my_data.AsLazy().TakeOrdered(20, std::less {}).ToVector() == std::vector< int > { 1, 2, 4, 4, 6, 7, 8, 9 }));
+    assert(my_data.AsLazy().OrderBy(std::less {}).Take(0).ToVector().empty());
+}
+
+void test_parallel_operators() {
+    auto data = std::vector< int >(100'003);
+    std::iota(data.begin(), data.end(), 0);
+    std::reverse(data.begin(), data.end());
+    auto       my_data = fp::LinqContainer< int > { data };
+    const auto policy  = fp::execution::parallel_policy { 1000 };
+
+    auto is_odd  = [](int x) { return x % 3 == 1; };
+    auto squared = [](int x) { return static_cast< long long >(x) * x; };
+
+    assert(std::ranges::equal(my_data.Where(policy, is_odd), my_data.Where(is_odd)));
+    assert(std::ranges::equal(my_data.Select(policy, squared), my_data.Select(squared)));
+    assert(std::ranges::equal(my_data.OrderBy(policy, std::less {}), my_data.OrderBy(std::less {})));
+    assert(std::ranges::equal(my_data.Select(fp::execution::seq, squared), my_data.Select(squared)));
+    assert(my_data.Select([](int x) { return static_cast< double >(x); }).Average(policy) == 50'001.);
+
+    std::atomic< long long > sum { 0 };
+    my_data.ForEach(policy, [&sum](int x) { sum += x; });
+    assert(sum == 100'002LL * 100'003 / 2);
+
+    auto empty = fp::LinqContainer< int > {};
+    assert(empty.Where(policy, is_odd).empty());
+    assert(empty.OrderBy(policy, std::less {}).empty());
+}
+
+void test_stream_source() {
+    // Generator source, pulled 7 records at a time
+    auto next      = 0;
+    auto generator = [&next]() -> std::optional< int > {
+        if (next == 100) return std::nullopt;
+        return next++;
+    };
+    const auto evens = fp::Stream< int >::FromGenerator(generator, 7).Where([](int x) { return x % 2 == 0; }).Select([](int x) { return x * 10; }).ToVector();
+    assert(evens.size() == 50 && evens.front() == 0 && evens.back() == 980);
+
+    // Taking a prefix stops pulling chunks
+    next = 0;
+    assert(fp::Stream< int >::FromGenerator(generator, 7).Take(3).Average() == 1);
+    assert(next == 7);
+
+    // Binary record file
+    const auto path    = std::filesystem::temp_directory_path() / "fp_stream_records.bin";
+    auto       records = std::vector< double >(1000);
+    std::iota(records.begin(), records.end(), 1.);
+    if (auto* file = std::fopen(path.string().c_str(), "wb")) {
+        std::fwrite(records.data(), sizeof(double), records.size(), file);
+        std::fclose(file);
+    }
+    assert(fp::Stream< double >::FromFile(path, 64).Average() == 500.5);
+    assert((fp::Stream< double >::FromFile(path, 64).TakeOrdered(2, std::greater {}).ToVector() == std::vector< double > { 1000., 999. }));
+    std::filesystem::remove(path);
+}
+
+void test_allocator_propagation() {
+    fp::Arena  arena {};
+    const auto alloc   = fp::ArenaAllocator< int > { arena };
+    const auto my_data = fp::LinqContainer< int, fp::ArenaAllocator< int > > { { 9, 4, 7, 1, 8 }, alloc };
+
+    auto used = arena.BytesUsed();
+    auto grew = [&]() { return std::exchange(used, arena.BytesUsed()) < used; };
+    assert(used > 0);
+
+    auto filtered = my_data.Where([](int x) { return x > 3; });
+    assert(grew() && filtered.get_allocator() == alloc && filtered.size() == 4);
+    auto doubled = filtered.Select([](int x) { return x * 2.; });
+    assert(grew() && &doubled.get_allocator().GetArena() == &arena);
+    auto ordered = my_data.OrderBy(std::greater {});
+    assert(grew() && ordered.get_allocator() == alloc && ordered.FirstOrDefault() == 9);
+    auto top = my_data.TakeOrdered(2, std::less {}).Take(1);
+    assert(grew() && top.FirstOrDefault() == 1);
+    auto lazy = my_data.AsLazy().OrderBy(std::less {}).Select([](int x) { return x + 1; }).ToVector();
+    assert(grew() && lazy.get_allocator() == alloc && lazy.back() == 10);
+    auto parallel = my_data.Where(fp::execution::par, [](int x) { return x < 5; });
+    assert(grew() && parallel.get_allocator() == alloc);
+
+    // std::pmr allocators are propagated the same way
+    std::pmr::monotonic_buffer_resource resource {};
+    auto pmr_data = fp::LinqContainer< int, std::pmr::polymorphic_allocator< int > > { { 3, 1, 2 }, &resource };
+    assert(pmr_data.Select([](int x) { return x * 0.5; }).get_allocator().resource() == &resource);
+    assert(pmr_data.OrderBy(std::less {}).get_allocator().resource() == &resource);
+
+    arena.Release();
+    assert(arena.BytesUsed() == 0);
+}
+
+#endif // LINQ_CONTAINER_TESTS
@@ -0,0 +1,58 @@
+﻿// LookupTests.h
+// This contains unit tests to the implementation in Lookup.hpp and the LinqContainer index operators
+
+#ifndef LOOKUP_TESTS
+#define LOOKUP_TESTS
+
+#include <LinqContainer.hpp>
+#include <Lookup.hpp>
+#include <cassert>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace lookup_tests {
+    enum class Color { Red, Green, Blue, Count };
+
+    struct Paint {
+        Color       color;
+        std::string name;
+    };
+} // namespace lookup_tests
+
+void test_lookup() {
+    using lookup_tests::Color;
+    using lookup_tests::Paint;
+    static_assert(fp::enum_size< Color >::value == 3);
+
+    const fp::LinqContainer< Paint > paints { { Color::Red, "ruby" }, { Color::Blue, "navy" }, { Color::Red, "cherry" } };
+
+    // Unique keys, member pointers as selectors
+    const fp::LinqContainer< Paint > unique { { Color::Red, "ruby" }, { Color::Blue, "navy" } };
+    const auto                       byColor = unique.ToDictionary(&Paint::color, &Paint::name);
+    static_assert(std::is_same_v< std::remove_const_t< decltype(byColor) >, fp::EnumDictionary< Color, std::string > >);
+    assert(byColor.size() == 2 && byColor.at(Color::Blue) == "navy");
+    assert(byColor.Find(Color::Green) == nullptr && byColor.FindOrDefault(Color::Green).empty());
+    assert(byColor.Find(static_cast< Color >(42)) == nullptr);
+
+    auto thrown = false;
+    try {
+        (void)paints.ToDictionary(&Paint::color);
+    } catch (const std::invalid_argument&) { thrown = true; }
+    assert(thrown);
+
+    // Non enum keys fall back to a hash map
+    const auto byName = paints.ToDictionary(&Paint::name, &Paint::color);
+    assert(byName.size() == 3 && byName.at("cherry") == Color::Red);
+
+    // One-to-many, source order kept within a key
+    const auto groups = paints.ToLookup(&Paint::color, &Paint::name);
+    assert(groups.size() == 3 && groups[Color::Red].size() == 2);
+    assert(groups[Color::Red][0] == "ruby" && groups[Color::Red][1] == "cherry");
+    assert(groups[Color::Green].empty() && !groups.contains(Color::Green));
+
+    const auto byLength = paints.ToLookup([](const Paint& paint) { return paint.name.size(); });
+    assert(byLength.at(4).size() == 2 && byLength.at(6).front().name == "cherry");
+}
+
+#endif // LOOKUP_TESTS
@@ -0,0 +1,78 @@
+﻿// LruCacheTests.h
+// This contains unit tests to the implementation in LruCache.hpp
+
+#ifndef LRU_CACHE_TESTS
+#define LRU_CACHE_TESTS
+
+#include <LruCache.hpp>
+#include <atomic>
+#include <cassert>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+void test_lru_cache() {
+    // Built on a miss, shared on a hit
+    fp::LruCache< int, std::string > cache { 2 };
+    auto                             builds = 0;
+    auto                             build  = [&builds](std::string value) {
+        return [&builds, value] {
+            ++builds;
+            return value;
+        };
+    };
+
+    const auto one = cache.GetOrAdd(1, build("one"));
+    assert(*one == "one" && builds == 1);
+    assert(cache.GetOrAdd(1, build("other")) == one && builds == 1);
+    assert(cache.Hits() == 1 && cache.Misses() == 1);
+
+    // The least recently used entry is evicted, a hit refreshes an entry
+    (void)cache.GetOrAdd(2, build("two"));
+    assert(cache.Find(1) != nullptr);
+    (void)cache.GetOrAdd(3, build("three"));
+    assert(cache.size() == 2 && cache.Capacity() == 2);
+    assert(cache.Find(2) == nullptr && *cache.Find(1) == "one" && *cache.Find(3) == "three");
+
+    // Evicted values stay alive while they are referenced
+    cache.Put(4, "four");
+    cache.Put(3, "THREE");
+    assert(cache.Find(1) == nullptr && *one == "one" && *cache.Find(3) == "THREE");
+
+    assert(cache.Erase(3) && !cache.Erase(3) && cache.size() == 1);
+    cache.Clear();
+    assert(cache.size() == 0 && cache.Find(4) == nullptr);
+
+    // A throwing factory caches nothing
+    auto thrown = false;
+    try {
+        (void)cache.GetOrAdd(5, []() -> std::string { throw std::runtime_error { "build failed" }; });
+    } catch (const std::runtime_error&) { thrown = true; }
+    assert(thrown && cache.Find(5) == nullptr);
+
+    thrown = false;
+    try {
+        fp::LruCache< int, int > empty { 0 };
+    } catch (const std::invalid_argument&) { thrown = true; }
+    assert(thrown);
+
+    // Concurrent readers of a shared set of keys all see one value per key
+    fp::LruCache< int, int >   shared { 8 };
+    std::atomic< int >         mismatches { 0 };
+    std::vector< std::thread > workers;
+    for (auto t = 0; t < 4; ++t) {
+        workers.emplace_back([&shared, &mismatches] {
+            for (auto i = 0; i < 1000; ++i) {
+                const auto key = i % 8;
+                if (*shared.GetOrAdd(key, [key] { return key * key; }) != key * key) ++mismatches;
+            }
+        });
+    }
+    for (auto& worker : workers) { worker.join(); }
+    assert(mismatches == 0 && shared.size() == 8);
+    assert(shared.Hits() + shared.Misses() == 4000);
+}
+
+#endif // LRU_CACHE_TESTS
@@ -0,0 +1,46 @@
+﻿// SimdTests.h
+// This contains unit tests to the implementation in Simd.hpp
+
+#ifndef SIMD_TESTS
+#define SIMD_TESTS
+
+#include <Simd.hpp>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <span>
+#include <vector>
+
+void test_simd_kernels() {
+    // Odd sizes exercise the vector body, the second accumulator and the scalar tail
+    for (const std::size_t size : { 0u, 1u, 3u, 8u, 17u, 1001u }) {
+        std::vector< double > values(size);
+        for (std::size_t i = 0; i < size; ++i) { values[i] = static_cast< double >((i * 37) % 101) - 50.5; }
+        const std::span< const double > column { values };
+
+        assert(std::abs(fp::simd::Sum(column) - std::accumulate(values.begin(), values.end(), 0.0)) < 1e-9);
+        if (size == 0) {
+            assert(std::isnan(fp::simd::Average(column)));
+            assert(std::isinf(fp::simd::Min(column)) && std::isinf(fp::simd::Max(column)));
+            continue;
+        }
+        assert(fp::simd::Min(column) == *std::min_element(values.begin(), values.end()));
+        assert(fp::simd::Max(column) == *std::max_element(values.begin(), values.end()));
+        assert(std::abs(fp::simd::Average(column) - std::accumulate(values.begin(), values.end(), 0.0) / size) < 1e-9);
+
+        std::vector< std::uint8_t > mask(size);
+        const auto selected = fp::simd::Mask(column, std::span { mask }, [](double value) { return value > 0; });
+        assert(selected == static_cast< std::size_t >(std::count_if(values.begin(), values.end(), [](double value) { return value > 0; })));
+        for (std::size_t i = 0; i < size; ++i) { assert(mask[i] == (values[i] > 0 ? 1 : 0)); }
+    }
+
+    std::vector< int > integers(77);
+    std::iota(integers.begin(), integers.end(), -5);
+    const std::span< const int > column { integers };
+    assert(fp::simd::Sum(column) == std::accumulate(integers.begin(), integers.end(), 0));
+    assert(fp::simd::Min(column) == -5 && fp::simd::Max(column) == 71);
+}
+
+#endif // SIMD_TESTS
@@ -0,0 +1,39 @@
+﻿// TaskSchedulerTests.h
+// This contains unit tests to the implementation in TaskScheduler.hpp
+
+#ifndef TASK_SCHEDULER_TESTS
+#define TASK_SCHEDULER_TESTS
+
+#include <TaskScheduler.hpp>
+#include <atomic>
+#include <cassert>
+#include <stdexcept>
+#include <vector>
+
+void test_task_scheduler() {
+    fp::TaskScheduler scheduler { 4 };
+
+    // Nested loops share the same workers
+    std::vector< std::atomic< int > > hits(64 * 64);
+    fp::parallel_for(
+        0, 64, 1,
+        [&](std::size_t outer) { fp::parallel_for(
+                                     0, 64, 4, [&](std::size_t inner) { hits[outer * 64 + inner]++; }, scheduler); },
+        scheduler);
+    for (auto& hit : hits) { assert(hit == 1); }
+
+    std::atomic< int > left { 0 }, right { 0 };
+    fp::parallel_invoke([&]() { left = 1; }, [&]() { right = 2; });
+    assert(left == 1 && right == 2);
+
+    auto thrown = false;
+    try {
+        fp::TaskGroup group { scheduler };
+        group.Run([]() { throw std::runtime_error { "task failed" }; });
+        group.Run([]() {});
+        group.Wait();
+    } catch (const std::runtime_error&) { thrown = true; }
+    assert(thrown);
+}
+
+#endif // TASK_SCHEDULER_TESTS
@@ -0,0 +1,91 @@
+﻿// TaskTests.h
+// This contains unit tests to the implementation in Task.hpp
+
+#ifndef TASK_TESTS
+#define TASK_TESTS
+
+#include <Task.hpp>
+#include <atomic>
+#include <cassert>
+#include <map>
+#include <stdexcept>
+#include <vector>
+
+namespace task_tests {
+    // In-process stand-in for an inventory service: a lookup completes later on a scheduler worker, like I/O would
+    struct InventoryStore {
+        fp::TaskScheduler&   scheduler;
+        std::map< int, int > stock {};
+        std::atomic< int >   lookups { 0 };
+
+        fp::Task< int > Available(int item) {
+            co_await fp::ScheduleOn(scheduler);
+            ++lookups;
+            co_return stock.at(item);
+        }
+    };
+
+    struct Order {
+        int item     = 0;
+        int quantity = 0;
+    };
+} // namespace task_tests
+
+void test_coroutine_tasks() {
+    using task_tests::InventoryStore;
+    using task_tests::Order;
+
+    fp::TaskScheduler scheduler { 2 };
+
+    // Lazy: nothing runs before the task is awaited. The coroutine lambdas are named, their captures must outlive the tasks
+    auto started  = false;
+    auto makeLazy = [&]() -> fp::Task< int > {
+        started = true;
+        co_return 42;
+    };
+    auto lazy = makeLazy();
+    assert(!started);
+    assert(fp::SyncWait(std::move(lazy), scheduler) == 42 && started);
+
+    // Synchronous and asynchronous stages chain, the store lookup suspends its order instead of blocking a thread
+    InventoryStore store { scheduler };
+    for (auto item = 0; item < 10; ++item) { store.stock[item] = item * 10; }
+
+    auto price = fp::ComposeAsync([](Order order) noexcept { return order.item; },
+                                  [&store](int item) { return store.Available(item); },
+                                  [](int available) noexcept { return available * 2; });
+    static_assert(std::is_same_v< decltype(price(Order {})), fp::Task< int > >);
+
+    std::vector< fp::Task< int > > orders;
+    for (auto i = 0; i < 1000; ++i) { orders.push_back(price(Order { i % 10, 1 })); }
+    const auto prices = fp::SyncWait(fp::WhenAll(std::move(orders), scheduler), scheduler);
+    assert(prices.size() == 1000 && store.lookups == 1000);
+    for (auto i = 0; i < 1000; ++i) { assert(prices[static_cast< std::size_t >(i)] == (i % 10) * 20); }
+
+    // Stages outlive the composed callable that started them
+    auto pending = [&]() {
+        auto once = fp::ComposeAsync([&store](int item) { return store.Available(item); });
+        return once(3);
+    }();
+    assert(fp::SyncWait(std::move(pending), scheduler) == 30);
+
+    // A failing lookup fails its order, WhenAll rethrows it once every order has finished
+    std::vector< fp::Task< int > > failing;
+    failing.push_back(price(Order { 1, 1 }));
+    failing.push_back(price(Order { 99, 1 }));
+    auto thrown = false;
+    try {
+        (void)fp::SyncWait(fp::WhenAll(std::move(failing), scheduler), scheduler);
+    } catch (const std::out_of_range&) { thrown = true; }
+    assert(thrown);
+
+    auto done     = false;
+    auto makeDone = [&]() -> fp::Task<> {
+        co_await fp::ScheduleOn(scheduler);
+        done = true;
+    };
+    fp::SyncWait(makeDone(), scheduler);
+    assert(done);
+}
+
+#endif // TASK_TESTS
@@ -0,0 +1,108 @@
+﻿// TracingTests.h
+// This contains unit tests to the implementation in Tracing.hpp
+
+#ifndef TRACING_TESTS
+#define TRACING_TESTS
+
+#include <CompositionHelper.hpp>
+#include <LINQ_CPP.hpp>
+#include <LinqContainer.hpp>
+#include <Tracing.hpp>
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace tracing_tests {
+    const fp::trace::OperatorSummary& Find(const std::vector< fp::trace::OperatorSummary >& summary, const char* name,
+                                           std::size_t stage = fp::trace::no_stage) {
+        const auto found = std::find_if(summary.begin(), summary.end(), [&](const auto& entry) { return entry.stage == stage && std::strcmp(entry.name, name) == 0; });
+        assert(found != summary.end());
+        return *found;
+    }
+} // namespace tracing_tests
+
+void test_tracing() {
+    using tracing_tests::Find;
+    static_assert(fp::trace::enabled);
+
+    const auto isEven  = [](int x) { return x % 2 == 0; };
+    const auto doubled = [](int x) { return x * 2; };
+    const fp::LinqContainer< int > numbers { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+
+    // Nothing is recorded without a collector
+    assert(fp::trace::Current() == nullptr);
+    assert(numbers.Where(isEven).size() == 5);
+
+    fp::trace::Collector collector {};
+    {
+        const fp::trace::ScopedCollector tracing { collector };
+        assert(fp::trace::Current() == &collector);
+
+        // Eager operators: one event per call, with counts, selectivity and the bytes of the result
+        assert(numbers.Where(isEven).Select(doubled).OrderBy(std::greater {}).Take(3).Average() == 16);
+        const auto summary = collector.Summary();
+        assert(summary.size() == 5);
+        const auto& where = Find(summary, "Where");
+        assert(where.calls == 1 && where.elementsIn == 10 && where.elementsOut == 5 && where.Selectivity() == 0.5);
+        assert(where.bytesAllocated == 10 * sizeof(int));
+        assert(Find(summary, "Select").elementsOut == 5 && Find(summary, "OrderBy").elementsIn == 5);
+        assert(Find(summary, "Take").elementsOut == 3 && Find(summary, "Average").elementsIn == 3 && Find(summary, "Average").elementsOut == 1);
+
+        // Lazy stages report their counts by position, the terminal reports the time of the fused loop
+        collector.Clear();
+        assert(numbers.AsLazy().Where(isEven).Select(doubled).OrderBy(std::less {}).Take(2).Average() == 6);
+        const auto lazy = collector.Summary();
+        assert(lazy.size() == 4);
+        assert(Find(lazy, "Where", 0).elementsIn == 10 && Find(lazy, "Where", 0).elementsOut == 5);
+        assert(Find(lazy, "Select", 1).elementsOut == 5);
+        const auto& topN = Find(lazy, "TakeOrdered", 2);
+        assert(topN.elementsIn == 5 && topN.elementsOut == 2 && topN.bytesAllocated >= 2 * sizeof(int));
+        assert(Find(lazy, "Average", 3).elementsIn == 2 && Find(lazy, "Average", 3).elementsOut == 1);
+
+        // Enumerable aggregates and composition stages
+        collector.Clear();
+        const linq::Enumerable values { 1, 2, 3 };
+        assert(values.Aggregate(0, std::plus {}) == 6);
+        auto composed = fp::Compose([](int x) { return x + 1; }, [](int x) { return x * 3; });
+        auto pipe     = fp::Pipe([](int x) { return x + 1; }, [](int x) { return x * 3; }, [](int x) { return x - 2; });
+        assert(composed(1) == 6 && composed(2) == 9 && pipe(1) == 4);
+        const auto stages = collector.Summary();
+        assert(Find(stages, "Aggregate").elementsIn == 3);
+        assert(Find(stages, "Compose", 0).calls == 2 && Find(stages, "Compose", 1).calls == 2);
+        assert(Find(stages, "Pipe", 0).calls == 1 && Find(stages, "Pipe", 2).calls == 1);
+
+        // Collectors nest, the previous one is restored
+        fp::trace::Collector inner {};
+        {
+            const fp::trace::ScopedCollector nested { inner };
+            assert(numbers.Take(2).size() == 2);
+        }
+        assert(fp::trace::Current() == &collector && inner.Summary().size() == 1);
+    }
+    assert(fp::trace::Current() == nullptr);
+
+    // Chrome trace-event JSON, one complete event per call, and the readable report
+    std::ostringstream trace {};
+    collector.WriteChromeTrace(trace);
+    const auto json = trace.str();
+    assert(json.starts_with("{\"displayTimeUnit\":\"ns\",\"traceEvents\":["));
+    assert(json.find("\"name\":\"Pipe[2]\"") != std::string::npos && json.find("\"ph\":\"X\"") != std::string::npos);
+    assert(static_cast< std::size_t >(std::count(json.begin(), json.end(), '{')) == 1 + 2 * collector.Events().size());
+    std::ostringstream report {};
+    collector.WriteReport(report);
+    assert(report.str().find("Compose[1]") != std::string::npos);
+
+    // Past maxEvents calls are only summarized
+    fp::trace::Collector bounded { 2 };
+    {
+        const fp::trace::ScopedCollector tracing { bounded };
+        for (auto i = 0; i < 3; ++i) { assert(numbers.Where(isEven).size() == 5); }
+    }
+    assert(bounded.Events().size() == 2 && bounded.DroppedEvents() == 1 && Find(bounded.Summary(), "Where").calls == 3);
+}
+
+#endif // TRACING_TESTS
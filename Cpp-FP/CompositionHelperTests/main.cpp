@@ -5,11 +5,49 @@
 // Created By: Michael Rizkalla
 // Date:		01/04/2021
 
+#include "AllocationTests.h"
+#include "AllocationTracking.h"
 #include "CompositionHelperTests.h"
+#include "EnumerableTests.h"
+#include "FPUtilityTests.h"
+#include "FixedDecimalTests.h"
+#include "FlatHashMapTests.h"
+#include "InplaceFunctionTests.h"
+#include "LinqContainerTests.h"
+#include "LookupTests.h"
+#include "LruCacheTests.h"
+#include "SimdTests.h"
+#include "TaskSchedulerTests.h"
+#include "TaskTests.h"
+#include "TracingTests.h"
 
 int main() {
-    test_function_composition();
-    test_lambda_composition();
-    test_free_compose();
-    test_combination();
+    RUN_TEST(test_function_composition);
+    RUN_TEST(test_lambda_composition);
+    RUN_TEST(test_free_compose);
+    RUN_TEST(test_static_compose);
+    RUN_TEST(test_pipe);
+    RUN_TEST(test_combination);
+    RUN_TEST(test_batch_apply);
+    RUN_TEST(test_move_aware_compose);
+    RUN_TEST(test_lazy_pipeline);
+    RUN_TEST(test_take_ordered);
+    RUN_TEST(test_parallel_operators);
+    RUN_TEST(test_stream_source);
+    RUN_TEST(test_allocator_propagation);
+    RUN_TEST(test_task_scheduler);
+    RUN_TEST(test_enumerable_select);
+    RUN_TEST(test_enumerable_sources);
+    RUN_TEST(test_enumerable_reductions);
+    RUN_TEST(test_inplace_function);
+    RUN_TEST(test_simd_kernels);
+    RUN_TEST(test_fixed_decimal);
+    RUN_TEST(test_lookup);
+    RUN_TEST(test_flat_hash_map);
+    RUN_TEST(test_hash_operators);
+    RUN_TEST(test_lru_cache);
+    RUN_TEST(test_coroutine_tasks);
+    RUN_TEST(test_allocate_unique);
+    RUN_TEST(test_tracing);
+    RUN_TEST(test_allocation_budgets);
 }
@@ -0,0 +1,138 @@
+// ArenaAllocator.hpp: Monotonic (bump) arena and the allocator handing out its memory
+//
+// An Arena serves every allocation of a pipeline from a few large blocks. Deallocation is a no-op,
+// everything is released at once by Release() or when the arena is destroyed. The arena is also a
+// std::pmr::memory_resource, so std::pmr containers can share it with fp::ArenaAllocator.
+// An arena is not thread-safe, use one per thread (e.g. one per request).
+
+#ifndef ARENA_ALLOCATOR_FP
+#define ARENA_ALLOCATOR_FP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+
+namespace fp {
+
+    class Arena final : public std::pmr::memory_resource {
+      public:
+        explicit Arena(std::size_t initialBlockSize = 64 * 1024, std::pmr::memory_resource* upstream_ = std::pmr::new_delete_resource()) :
+            nextBlockSize(std::max< std::size_t >(initialBlockSize, sizeof(Block) * 2)), upstream(upstream_) {}
+        // Uses the caller's buffer first, then falls back to blocks from upstream
+        Arena(void* buffer, std::size_t size, std::pmr::memory_resource* upstream_ = std::pmr::new_delete_resource()) :
+            current(static_cast< std::byte* >(buffer)), remaining(size), nextBlockSize(std::max< std::size_t >(size, sizeof(Block) * 2)), upstream(upstream_),
+            initialBuffer(static_cast< std::byte* >(buffer)), initialSize(size) {}
+        ~Arena() override { Release(); }
+
+        Arena(const Arena&) = delete;
+        Arena& operator=(const Arena&) = delete;
+
+        // Frees every block in one shot, all memory handed out so far becomes invalid
+        void Release() noexcept {
+            while (blocks != nullptr) {
+                auto* previous = blocks->previous;
+                upstream->deallocate(blocks, blocks->size, alignof(std::max_align_t));
+                blocks = previous;
+            }
+            current   = initialBuffer;
+            remaining = initialSize;
+            used      = 0;
+        }
+
+        // Bytes handed out since construction or the last Release()
+        [[nodiscard]] std::size_t BytesUsed() const noexcept { return used; }
+
+      protected:
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+            auto* aligned = Align(bytes, alignment);
+            if (aligned == nullptr) {
+                Grow(bytes + alignment);
+                aligned = Align(bytes, alignment);
+            }
+            current = aligned + bytes;
+            remaining -= bytes;
+            used += bytes;
+            return aligned;
+        }
+
+        void do_deallocate(void*, std::size_t, std::size_t) override {}
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+      private:
+        struct Block {
+            Block*      previous;
+            std::size_t size;
+        };
+
+        std::byte* Align(std::size_t bytes, std::size_t alignment) noexcept {
+            void* pointer = current;
+            if (pointer == nullptr || std::align(alignment, bytes, pointer, remaining) == nullptr) return nullptr;
+            current = static_cast< std::byte* >(pointer);
+            return current;
+        }
+
+        void Grow(std::size_t minimum) {
+            const auto size   = std::max(nextBlockSize, minimum + sizeof(Block));
+            auto*      memory = upstream->allocate(size, alignof(std::max_align_t));
+
+            blocks        = ::new (memory) Block { blocks, size };
+            current       = static_cast< std::byte* >(memory) + sizeof(Block);
+            remaining     = size - sizeof(Block);
+            nextBlockSize = size * 2;
+        }
+
+        Block*                     blocks    = nullptr;
+        std::byte*                 current   = nullptr;
+        std::size_t                remaining = 0;
+        std::size_t                used      = 0;
+        std::size_t                nextBlockSize;
+        std::pmr::memory_resource* upstream;
+        std::byte*                 initialBuffer = nullptr;
+        std::size_t                initialSize   = 0;
+    };
+
+    /// <summary>
+    /// Allocator handing out memory from an Arena, deallocate is a no-op
+    /// Rebinding keeps the same arena, so it follows a LinqContainer chain through Select
+    /// </summary>
+    template < class Type >
+    class ArenaAllocator {
+      public:
+        using value_type                             = Type;
+        using propagate_on_container_copy_assignment = std::true_type;
+        using propagate_on_container_move_assignment = std::true_type;
+        using propagate_on_container_swap            = std::true_type;
+        using is_always_equal                        = std::false_type;
+
+        ArenaAllocator(Arena& arena_) noexcept : arena(&arena_) {}
+        template < class Other >
+        ArenaAllocator(const ArenaAllocator< Other >& other) noexcept : arena(other.arena) {}
+
+        [[nodiscard]] Type* allocate(std::size_t count) {
+            if (count > std::size_t(-1) / sizeof(Type)) throw std::bad_array_new_length {};
+            return static_cast< Type* >(arena->allocate(count * sizeof(Type), alignof(Type)));
+        }
+        void deallocate(Type*, std::size_t) noexcept {}
+
+        [[nodiscard]] Arena& GetArena() const noexcept { return *arena; }
+
+        template < class Other >
+        friend class ArenaAllocator;
+
+        template < class Other >
+        [[nodiscard]] bool operator==(const ArenaAllocator< Other >& other) const noexcept {
+            return arena == other.arena;
+        }
+
+      private:
+        Arena* arena;
+    };
+
+} // namespace fp
+
+#endif // ARENA_ALLOCATOR_FP
@@ -7,9 +7,17 @@
 #ifndef COMPOSITION_HELPER_HEADER
 #define COMPOSITION_HELPER_HEADER
 // Not using #pragma once since it's not a part of the standard
+#include <Tracing.hpp>
 #include <Traits.hpp>
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
 #include <functional>
+#include <span>
+#include <stdexcept>
 #include <stdint.h>
+#include <tuple>
 #include <type_traits>
 #include <utility>
 
@@ -18,6 +26,11 @@ namespace fp {
     template < class Signature, class Closure = void >
     struct CompositionFunction;
 
+    enum class BatchMode : std::uint8_t { Staged, Fused };
+
+    // Elements of a block in CompositionFunction::Apply
+    inline constexpr std::size_t batch_block_size = 256;
+
     namespace impl {
 
         template < class... >
@@ -41,6 +54,122 @@ namespace fp {
             using type = CompositionFunctionBase< Closure, RetType(Args...) >;
         };
 
+        /// <summary>
+        /// The callable of a composition: Second(First(args))
+        /// Stages are kept as named members, so a batch evaluation can run them one at a time
+        /// </summary>
+        template < class First, class Second, class RetType, class... Args >
+        struct ComposedFunction {
+            mutable First  first;
+            mutable Second second;
+
+            constexpr RetType operator()(Args... args) const noexcept(noexcept(std::declval< Second& >()(std::declval< First& >()(std::declval< Args >()...)))) {
+                return trace::Invoke("Compose", 1, second, trace::Invoke("Compose", 0, first, std::forward< Args >(args)...));
+            }
+        };
+
+        template < class RetType, class ArgsList, class... Stages >
+        struct PipeFunction;
+
+        /// <summary>
+        /// The callable of a pipe: Stages[n-1](...Stages[1](Stages[0](args)))
+        /// All stages live in one flat tuple and are called in one chain, there is no wrapper per stage
+        /// </summary>
+        template < class RetType, template < class... > class List, class... Args, class... Stages >
+        struct PipeFunction< RetType, List< Args... >, Stages... > {
+            static constexpr std::size_t stage_count = sizeof...(Stages);
+            static constexpr bool        no_except   = (functor_traits< Stages >::has_noexcept && ...);
+
+            mutable std::tuple< Stages... > stages;
+
+            constexpr RetType operator()(Args... args) const noexcept(no_except) {
+                return CallFrom< 1 >(trace::Invoke("Pipe", 0, std::get< 0 >(stages), std::forward< Args >(args)...));
+            }
+
+            // Runs the stages from Index on, value is the result of stage Index - 1
+            template < std::size_t Index, class Value >
+            constexpr RetType CallFrom(Value&& value) const noexcept(no_except) {
+                if constexpr (Index == stage_count) {
+                    return std::forward< Value >(value);
+                } else {
+                    return CallFrom< Index + 1 >(trace::Invoke("Pipe", Index, std::get< Index >(stages), std::forward< Value >(value)));
+                }
+            }
+        };
+
+        template < class RetType, class ArgsList >
+        struct PipeSignature;
+        template < class RetType, template < class... > class List, class... Args >
+        struct PipeSignature< RetType, List< Args... > > {
+            using type = RetType(Args...);
+        };
+
+        // Every stage is composable with the next one
+        template < class... Stages >
+        inline constexpr bool chain_composable = true;
+        template < class First, class Second, class... Rest >
+        inline constexpr bool chain_composable< First, Second, Rest... > = composable< First, Second > && chain_composable< Second, Rest... >;
+
+        template < class >
+        inline constexpr bool is_composed_function = false;
+        template < class First, class Second, class RetType, class... Args >
+        inline constexpr bool is_composed_function< ComposedFunction< First, Second, RetType, Args... > > = true;
+
+        template < class >
+        inline constexpr bool is_pipe_function = false;
+        template < class RetType, class ArgsList, class... Stages >
+        inline constexpr bool is_pipe_function< PipeFunction< RetType, ArgsList, Stages... > > = true;
+
+        // Intermediate values of a block are kept on the stack, bigger ones make the stage fall back to a fused loop
+        inline constexpr std::size_t batch_buffer_bytes = 16 * 1024;
+
+        template < class Intermediate >
+        inline constexpr bool bufferable = std::default_initializable< Intermediate > && sizeof(Intermediate) * batch_block_size <= batch_buffer_bytes;
+
+        template < std::size_t Index, class Pipe, class Input, class Output >
+        void ApplyPipeStages(Pipe& pipe, std::span< const Input > input, std::span< Output > output);
+
+        template < class Function, class Input, class Output >
+        void ApplyStages(Function& function, std::span< const Input > input, std::span< Output > output) {
+            if constexpr (is_composed_function< Function >) {
+                using Intermediate = std::remove_cvref_t< std::invoke_result_t< decltype(function.first)&, const Input& > >;
+
+                if constexpr (bufferable< Intermediate >) {
+                    std::array< Intermediate, batch_block_size > buffer;
+                    const auto                                   intermediate = std::span { buffer }.first(input.size());
+                    ApplyStages(function.first, input, intermediate);
+                    ApplyStages(function.second, std::span< const Intermediate > { intermediate }, output);
+                } else {
+                    for (std::size_t i = 0; i < input.size(); ++i) { output[i] = function(input[i]); }
+                }
+            } else if constexpr (is_pipe_function< Function >) {
+                ApplyPipeStages< 0 >(function, input, output);
+            } else if constexpr (std::is_base_of_v< ICompositionFunction, Function >) {
+                function.Apply(input, output);
+            } else {
+                for (std::size_t i = 0; i < input.size(); ++i) { output[i] = function(input[i]); }
+            }
+        }
+
+        template < std::size_t Index, class Pipe, class Input, class Output >
+        void ApplyPipeStages(Pipe& pipe, std::span< const Input > input, std::span< Output > output) {
+            auto& stage = std::get< Index >(pipe.stages);
+            if constexpr (Index + 1 == Pipe::stage_count) {
+                ApplyStages(stage, input, output);
+            } else {
+                using Intermediate = std::remove_cvref_t< std::invoke_result_t< decltype(stage), const Input& > >;
+
+                if constexpr (bufferable< Intermediate >) {
+                    std::array< Intermediate, batch_block_size > buffer;
+                    const auto                                   intermediate = std::span { buffer }.first(input.size());
+                    ApplyStages(stage, input, intermediate);
+                    ApplyPipeStages< Index + 1 >(pipe, std::span< const Intermediate > { intermediate }, output);
+                } else {
+                    for (std::size_t i = 0; i < input.size(); ++i) { output[i] = pipe.template CallFrom< Index + 1 >(stage(input[i])); }
+                }
+            }
+        }
+
         template < class NoExcept, class Closure, class RetType, class... Args >
         using BaseChooser = std::conditional_t<
             std::is_same_v< Closure, void >,
@@ -65,25 +194,43 @@ namespace fp {
 
             [[nodiscard]] constexpr auto operator()(Args... args) const noexcept(noexcept(std::declval< UnderlyingFunctionType >()(std::declval< Args >()...)))
                 -> RetType {
-                return function_(args...);
+                return function_(std::forward< Args >(args)...);
             }
 
             [[nodiscard]] constexpr auto operator->() const noexcept requires std::is_class_v< std::remove_cvref_t< UnderlyingFunctionType > > { return &function_; }
 
+            // Copies this function into the composition, secondFunc is moved when it is an rvalue.
+            // Pass std::ref(callable) to borrow a callable instead, it must outlive the composition
             template < class SecondCallable, class ComposedRetType = typename functor_traits< std::decay_t< SecondCallable > >::return_type >
-            [[nodiscard]] auto Compose(SecondCallable&& secondFunc) const requires composable< std::decay_t< UnderlyingFunctionType >, std::decay_t< SecondCallable > > {
-                if constexpr (functor_traits< SecondCallable >::has_const && functor_traits< UnderlyingFunctionType >::has_const) {
-                    auto composedFunction = [function__ = function_, secondFunc](Args... args) noexcept(noexcept(std::declval< SecondCallable >()(
-                                                std::declval< UnderlyingFunctionType >()(std::declval< Args >()...)))) -> ComposedRetType {
-                        return secondFunc(function__(std::forward< Args >(args)...));
-                    };
-                    return CompositionFunction< ComposedRetType(Args...), decltype(composedFunction) >(std::move(composedFunction));
-                } else {
-                    auto composedFunction = [function__ = function_, secondFunc](Args... args) mutable noexcept(noexcept(std::declval< SecondCallable >()(
-                                                std::declval< UnderlyingFunctionType >()(std::declval< Args >()...)))) -> ComposedRetType {
-                        return secondFunc(function__(std::forward< Args >(args)...));
-                    };
-                    return CompositionFunction< ComposedRetType(Args...), decltype(composedFunction) >(std::move(composedFunction));
+            [[nodiscard]] auto Compose(SecondCallable&& secondFunc) const& requires composable< std::decay_t< UnderlyingFunctionType >, std::decay_t< SecondCallable > > {
+                using Composed = ComposedFunction< UnderlyingFunctionType, std::decay_t< SecondCallable >, ComposedRetType, Args... >;
+                return CompositionFunction< ComposedRetType(Args...), Composed >(Composed { function_, std::forward< SecondCallable >(secondFunc) });
+            }
+
+            // Moves this function into the composition, building a chain of temporaries copies no stage
+            template < class SecondCallable, class ComposedRetType = typename functor_traits< std::decay_t< SecondCallable > >::return_type >
+            [[nodiscard]] auto Compose(SecondCallable&& secondFunc) && requires composable< std::decay_t< UnderlyingFunctionType >, std::decay_t< SecondCallable > > {
+                using Composed = ComposedFunction< UnderlyingFunctionType, std::decay_t< SecondCallable >, ComposedRetType, Args... >;
+                return CompositionFunction< ComposedRetType(Args...), Composed >(Composed { std::move(function_), std::forward< SecondCallable >(secondFunc) });
+            }
+
+            /// <summary>
+            /// Evaluates the function over input into output (output[i] = F(input[i])), input is processed in blocks of batch_block_size.
+            /// Staged runs every stage of a composition over the whole block before the next stage, the intermediate
+            /// values of a block stay in a cache-sized buffer and simple stages get a tight loop the compiler can vectorize.
+            /// Fused calls the whole composition once per element.
+            /// </summary>
+            template < class Input, class Output >
+            requires(sizeof...(Args) == 1) void Apply(std::span< const Input > input, std::span< Output > output, BatchMode mode = BatchMode::Staged) const {
+                if (output.size() < input.size()) throw std::invalid_argument { "Apply output is smaller than its input" };
+
+                if (mode == BatchMode::Fused) {
+                    for (std::size_t i = 0; i < input.size(); ++i) { output[i] = function_(input[i]); }
+                    return;
+                }
+                for (std::size_t offset = 0; offset < input.size(); offset += batch_block_size) {
+                    const auto count = std::min(batch_block_size, input.size() - offset);
+                    ApplyStages(function_, input.subspan(offset, count), output.subspan(offset, count));
                 }
             }
 
@@ -162,20 +309,8 @@ namespace fp {
         template < class FirstCallable, class SecondCallable, class RetType, template < class... > class List, class... Args >
         struct Composer< FirstCallable, SecondCallable, RetType, List< Args... > > {
             [[nodiscard]] constexpr static auto Compose(FirstCallable&& firstFunc, SecondCallable&& secondFunc) {
-
-                if constexpr (functor_traits< SecondCallable >::has_const && functor_traits< FirstCallable >::has_const) {
-                    auto composedFunction = [firstFunc_ = firstFunc, secondFunc_ = secondFunc](Args... args) noexcept(
-                                                noexcept(std::declval< SecondCallable >()(std::declval< FirstCallable >()(std::declval< Args >()...)))) -> RetType {
-                        return secondFunc_(firstFunc_(std::forward< Args >(args)...));
-                    };
-                    return CompositionFunction< RetType(Args...), decltype(composedFunction) >(std::move(composedFunction));
-                } else {
-                    auto composedFunction = [firstFunc_ = firstFunc, secondFunc_ = secondFunc](Args... args) mutable noexcept(
-                                                noexcept(std::declval< SecondCallable >()(std::declval< FirstCallable >()(std::declval< Args >()...)))) -> RetType {
-                        return secondFunc_(firstFunc_(std::forward< Args >(args)...));
-                    };
-                    return CompositionFunction< RetType(Args...), decltype(composedFunction) >(std::move(composedFunction));
-                }
+                using Composed = ComposedFunction< FirstCallable, SecondCallable, RetType, Args... >;
+                return CompositionFunction< RetType(Args...), Composed >(Composed { std::move(firstFunc), std::move(secondFunc) });
             }
         };
 
@@ -183,6 +318,7 @@ namespace fp {
 
     /// <summary>
     /// Composes two callables into one Compose(X, Y) -> Y(X(Args))
+    /// The callables are stored by value: lvalues are copied once and rvalues moved, std::ref(X) borrows X instead
     /// </summary>
     /// <param name="firstFunc">First callable X</param>
     /// <param name="secondFunc">Second callable Y</param>
@@ -194,6 +330,38 @@ namespace fp {
         return impl::Composer< FirstCallable, SecondCallable, RetType, ArgsList >::Compose(std::move(firstFunc), std::move(secondFunc));
     }
 
+    /// <summary>
+    /// Composes any number of callables into one Pipe(X, Y, Z) -> Z(Y(X(Args)))
+    /// Unlike chained Compose calls the stages are stored flat, the result is as big as the stages and is called in one chain.
+    /// Callables are stored like in Compose: lvalues are copied once, rvalues moved and std::ref(X) borrows X
+    /// </summary>
+    /// <param name="callables">Stages in call order, each one composable with the next</param>
+    /// <returns>CompositionFunction</returns>
+    template < class... Callables >
+    requires(sizeof...(Callables) > 0 && impl::chain_composable< std::decay_t< Callables >... >) [[nodiscard]] constexpr auto Pipe(Callables&&... callables) {
+        using First     = std::tuple_element_t< 0, std::tuple< std::decay_t< Callables >... > >;
+        using Last      = std::tuple_element_t< sizeof...(Callables) - 1, std::tuple< std::decay_t< Callables >... > >;
+        using RetType   = typename functor_traits< Last >::return_type;
+        using ArgsList  = typename functor_traits< First >::argument_types;
+        using Piped     = impl::PipeFunction< RetType, ArgsList, std::decay_t< Callables >... >;
+        using Signature = typename impl::PipeSignature< RetType, ArgsList >::type;
+
+        return CompositionFunction< Signature, Piped >(Piped { { std::forward< Callables >(callables)... } });
+    }
+
+    template < auto Function >
+    struct StaticFunction;
+
+    /// <summary>
+    /// Stateless callable for a function known at compile time
+    /// Composing it stores no pointer, the composed call is a direct call the compiler can inline
+    /// </summary>
+    /// <typeparam name="Function">Pointer to a free or static member function</typeparam>
+    template < class RetType, class... Args, bool NoExcept, RetType (*Function)(Args...) noexcept(NoExcept) >
+    struct StaticFunction< Function > {
+        [[nodiscard]] constexpr RetType operator()(Args... args) const noexcept(NoExcept) { return Function(std::forward< Args >(args)...); }
+    };
+
 } // namespace fp
 
 #endif // COMPOSITION_HELPER_HEADER
@@ -0,0 +1,73 @@
+// Execution.hpp: Execution policies accepted by the LinqContainer operators
+// and the chunked parallel loop backing them
+
+#ifndef EXECUTION_FP
+#define EXECUTION_FP
+
+#include <TaskScheduler.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace fp {
+
+    namespace execution {
+
+        struct sequenced_policy {};
+
+        /// <summary>
+        /// Runs an operator in chunks of at least grain_size elements on TaskScheduler::Default()
+        /// Callables passed along with it are invoked concurrently and must be thread-safe
+        /// </summary>
+        struct parallel_policy {
+            std::size_t grain_size = 4096;
+        };
+
+        inline constexpr sequenced_policy seq {};
+        inline constexpr parallel_policy  par {};
+
+        template < class Type >
+        concept execution_policy = std::is_same_v< std::remove_cvref_t< Type >, sequenced_policy > || std::is_same_v< std::remove_cvref_t< Type >, parallel_policy >;
+
+    } // namespace execution
+
+    namespace impl {
+
+        [[nodiscard]] inline std::size_t ConcurrencyLevel() { return TaskScheduler::Default().Concurrency(); }
+
+        // Number of chunks to split `size` elements into, never less than one chunk
+        [[nodiscard]] inline std::size_t ChunkCount(std::size_t size, std::size_t grain_size) {
+            const auto byGrain = (size + std::max< std::size_t >(grain_size, 1) - 1) / std::max< std::size_t >(grain_size, 1);
+            return std::clamp< std::size_t >(byGrain, 1, ConcurrencyLevel() * 4);
+        }
+
+        // [begin, end) of chunk `index` when `size` elements are split into `chunks` chunks
+        [[nodiscard]] inline std::pair< std::size_t, std::size_t > ChunkRange(std::size_t size, std::size_t chunks, std::size_t index) noexcept {
+            const auto base      = size / chunks;
+            const auto remainder = size % chunks;
+            const auto begin     = index * base + std::min(index, remainder);
+
+            return { begin, begin + base + (index < remainder ? 1 : 0) };
+        }
+
+        // Invokes func(i) for every i in [0, count) as separate tasks on the default scheduler
+        template < class Func >
+        void ParallelFor(std::size_t count, Func&& func) {
+            parallel_for(0, count, 1, std::forward< Func >(func));
+        }
+
+        // Splits [0, size) into chunks and invokes func(chunk, begin, end) for each of them in parallel
+        template < class Func >
+        void ParallelChunks(std::size_t size, std::size_t chunks, Func&& func) {
+            ParallelFor(chunks, [&](std::size_t chunk) {
+                const auto [begin, end] = ChunkRange(size, chunks, chunk);
+                func(chunk, begin, end);
+            });
+        }
+
+    } // namespace impl
+
+} // namespace fp
+
+#endif // EXECUTION_FP
@@ -1,64 +1,232 @@
 
 #ifndef FP_UTILITY_HPP
 #define FP_UTILITY_HPP
+#include <array>
 #include <cmath>
+#include <cstddef>
 #include <memory>
+#include <new>
 #include <string>
+#include <type_traits>
+#include <utility>
 
 namespace fp {
 
-    template < class Type, class Allocator, class... TArgs, std::enable_if_t< !std::is_array_v< Type >, int > = 0 >
-    std::unique_ptr< Type, std::function< void(Type*) > > allocate_unique(Allocator alloc, TArgs... args) {
-        using allocator_type = std::allocator_traits< Allocator >::template rebind_alloc< Type >;
+    /// <summary>
+    /// Deleter of the pointers returned by allocate_unique: destroys and deallocates with the allocator it holds.
+    /// The allocator's value_type is the type that was constructed, Type may be one of its bases.
+    /// Stateless allocators take no space, std::unique_ptr< Type, AllocatorDeleter<...> > is then pointer-sized.
+    /// </summary>
+    template < class Type, class Allocator >
+    class AllocatorDeleter {
+        using traits      = std::allocator_traits< Allocator >;
+        using constructed = typename traits::value_type;
+
+      public:
+        AllocatorDeleter() = default;
+        explicit AllocatorDeleter(const Allocator& alloc_) noexcept : alloc(alloc_) {}
+
+        void operator()(Type* ptr) noexcept {
+            auto* object = static_cast< constructed* >(ptr);
+            traits::destroy(alloc, object);
+            traits::deallocate(alloc, object, 1);
+        }
 
-        auto custom_deleter = [](Type* ptr, allocator_type m_alloc) {
-            std::allocator_traits< allocator_type >::destroy(m_alloc, ptr);
-            m_alloc.deallocate(ptr, 1);
-        };
+        [[nodiscard]] const Allocator& get_allocator() const noexcept { return alloc; }
+
+      private:
+        [[no_unique_address]] Allocator alloc {};
+    };
+
+    // Arrays also keep their element count, deallocation needs it
+    template < class Type, class Allocator >
+    class AllocatorDeleter< Type[], Allocator > {
+        using traits = std::allocator_traits< Allocator >;
+
+      public:
+        AllocatorDeleter() = default;
+        AllocatorDeleter(const Allocator& alloc_, std::size_t size_) noexcept : alloc(alloc_), size(size_) {}
+
+        void operator()(Type* ptr) noexcept {
+            for (std::size_t i = 0; i < size; ++i) { traits::destroy(alloc, ptr + i); }
+            traits::deallocate(alloc, ptr, size);
+        }
+
+        [[nodiscard]] const Allocator& get_allocator() const noexcept { return alloc; }
+
+      private:
+        [[no_unique_address]] Allocator alloc {};
+        std::size_t                     size = 0;
+    };
+
+    template < class Type, class Allocator, class... TArgs, std::enable_if_t< !std::is_array_v< Type >, int > = 0 >
+    auto allocate_unique(const Allocator& alloc, TArgs&&... args) {
+        using allocator_type = typename std::allocator_traits< Allocator >::template rebind_alloc< Type >;
+        using traits         = std::allocator_traits< allocator_type >;
 
         allocator_type type_alloc { alloc };
 
-        Type* ptr = type_alloc.allocate(1);
-        std::allocator_traits< allocator_type >::construct(alloc, ptr, std::forward< TArgs >(args)...);
+        Type* ptr = traits::allocate(type_alloc, 1);
+        try {
+            traits::construct(type_alloc, ptr, std::forward< TArgs >(args)...);
+        } catch (...) {
+            traits::deallocate(type_alloc, ptr, 1);
+            throw;
+        }
 
-        return { ptr, std::bind(custom_deleter, std::placeholders::_1, type_alloc) };
+        return std::unique_ptr< Type, AllocatorDeleter< Type, allocator_type > > { ptr, AllocatorDeleter< Type, allocator_type > { type_alloc } };
     }
 
+    // Constructs a ConstructedType and owns it through a Type pointer, the deleter still frees a ConstructedType
     template < class Type, class ConstructedType, class Allocator, class... TArgs, std::enable_if_t< !std::is_array_v< Type >, int > = 0 >
-    std::unique_ptr< Type, std::function< void(Type*) > > allocate_unique(Allocator alloc, TArgs... args) {
-        using constructor    = std::allocator_traits< Allocator >::template rebind_alloc< ConstructedType >;
-
-        auto custom_deleter = [](Type* ptr, constructor c_alloc) {
-            std::allocator_traits< constructor >::destroy(c_alloc, reinterpret_cast< ConstructedType* >(ptr));
-            c_alloc.deallocate(reinterpret_cast< ConstructedType* >(ptr), 1);
-        };
+    auto allocate_unique(const Allocator& alloc, TArgs&&... args) {
+        static_assert(std::is_base_of_v< Type, ConstructedType > || std::is_same_v< Type, ConstructedType >, "ConstructedType must derive from Type");
+        using constructor = typename std::allocator_traits< Allocator >::template rebind_alloc< ConstructedType >;
+        using traits      = std::allocator_traits< constructor >;
 
         constructor ctor_alloc { alloc };
 
-        ConstructedType* ptr = ctor_alloc.allocate(1);
-        std::allocator_traits< constructor >::construct(ctor_alloc, ptr, std::forward< TArgs >(args)...);
+        ConstructedType* ptr = traits::allocate(ctor_alloc, 1);
+        try {
+            traits::construct(ctor_alloc, ptr, std::forward< TArgs >(args)...);
+        } catch (...) {
+            traits::deallocate(ctor_alloc, ptr, 1);
+            throw;
+        }
 
-        return { static_cast< Type* >(ptr), std::bind(custom_deleter, std::placeholders::_1, ctor_alloc) };
+        return std::unique_ptr< Type, AllocatorDeleter< Type, constructor > > { static_cast< Type* >(ptr), AllocatorDeleter< Type, constructor > { ctor_alloc } };
     }
 
     template < class ArrayType, class Allocator, std::enable_if_t< std::is_array_v< ArrayType > && std::extent_v< ArrayType > == 0, int > = 0 >
-    std::unique_ptr< ArrayType, std::function< void(std::remove_extent_t< ArrayType >*) > > allocate_unique(Allocator alloc, const std::size_t size) {
+    auto allocate_unique(const Allocator& alloc, const std::size_t size) {
         using Type           = std::remove_extent_t< ArrayType >;
-        using allocator_type = std::allocator_traits< Allocator >::template rebind_alloc< Type >;
-
-        auto custom_array_deleter = [](Type* ptr, allocator_type m_alloc, std::size_t m_size) {
-            for (std::size_t i = 0; i < m_size; ++i) { std::allocator_traits< allocator_type >::destroy(m_alloc, ptr + i); }
-            m_alloc.deallocate(ptr, m_size);
-        };
+        using allocator_type = typename std::allocator_traits< Allocator >::template rebind_alloc< Type >;
+        using traits         = std::allocator_traits< allocator_type >;
+        using deleter        = AllocatorDeleter< Type[], allocator_type >;
 
         allocator_type type_alloc { alloc };
 
-        Type* ptr = type_alloc.allocate(size);
-        if constexpr (std::is_default_constructible_v< Type >) {
-            for (std::size_t i = 0; i < size; ++i) { std::allocator_traits< allocator_type >::construct(alloc, ptr + i); }
+        Type*       ptr         = traits::allocate(type_alloc, size);
+        std::size_t constructed = 0;
+        try {
+            for (; constructed < size; ++constructed) { traits::construct(type_alloc, ptr + constructed); }
+        } catch (...) {
+            while (constructed != 0) { traits::destroy(type_alloc, ptr + --constructed); }
+            traits::deallocate(type_alloc, ptr, size);
+            throw;
         }
 
-        return { ptr, std::bind(custom_array_deleter, std::placeholders::_1, type_alloc, size) };
+        return std::unique_ptr< ArrayType, deleter > { ptr, deleter { type_alloc, size } };
+    }
+
+    namespace impl {
+        // Per-thread free lists of pooled nodes, one list per size class. A node is a header holding its
+        // size class followed by the object, so the deleter needs no state to give it back
+        class NodePool {
+          public:
+            static constexpr std::size_t header_size  = alignof(std::max_align_t);
+            static constexpr std::size_t granularity  = alignof(std::max_align_t);
+            static constexpr std::size_t class_count  = 16;
+            static constexpr std::size_t unpooled     = class_count;
+            static constexpr std::size_t cached_nodes = 64;
+
+            static constexpr std::size_t SizeClass(std::size_t bytes) noexcept {
+                const auto sizeClass = (bytes + granularity - 1) / granularity - 1;
+                return sizeClass < class_count ? sizeClass : unpooled;
+            }
+
+            static NodePool& Local() noexcept {
+                thread_local NodePool pool {};
+                return pool;
+            }
+
+            NodePool() = default;
+            NodePool(const NodePool&) = delete;
+            NodePool& operator=(const NodePool&) = delete;
+            ~NodePool() {
+                for (auto& head : heads) {
+                    while (head != nullptr) { ::operator delete(std::exchange(head, head->next)); }
+                }
+            }
+
+            // Storage for an object of `bytes` bytes, the header is already written
+            void* Allocate(std::size_t bytes) {
+                const auto sizeClass = SizeClass(bytes);
+                void*      node      = nullptr;
+                if (sizeClass != unpooled && heads[sizeClass] != nullptr) {
+                    node = std::exchange(heads[sizeClass], heads[sizeClass]->next);
+                    --counts[sizeClass];
+                } else {
+                    node = ::operator new(header_size + (sizeClass != unpooled ? (sizeClass + 1) * granularity : bytes));
+                }
+                *static_cast< std::size_t* >(node) = sizeClass;
+                return static_cast< std::byte* >(node) + header_size;
+            }
+
+            // Takes back the storage of an object already destroyed
+            void Deallocate(void* object) noexcept {
+                void*      node      = static_cast< std::byte* >(object) - header_size;
+                const auto sizeClass = *static_cast< const std::size_t* >(node);
+                if (sizeClass == unpooled || counts[sizeClass] == cached_nodes) {
+                    ::operator delete(node);
+                    return;
+                }
+                heads[sizeClass] = ::new (node) FreeNode { heads[sizeClass] };
+                ++counts[sizeClass];
+            }
+
+          private:
+            struct FreeNode {
+                FreeNode* next;
+            };
+
+            std::array< FreeNode*, class_count >   heads {};
+            std::array< std::size_t, class_count > counts {};
+        };
+    } // namespace impl
+
+    /// <summary>
+    /// Stateless deleter of the pointers returned by allocate_pooled, so std::unique_ptr< Type, PooledDeleter< Type > >
+    /// is pointer-sized and one type whatever was constructed. Nodes go back to the pool of the deleting thread
+    /// </summary>
+    template < class Type >
+    struct PooledDeleter {
+        PooledDeleter() = default;
+        // Ownership may move to a base, the node is found from the most derived object
+        template < class Derived >
+        requires std::is_convertible_v< Derived*, Type* >
+        PooledDeleter(PooledDeleter< Derived >) noexcept {}
+
+        void operator()(Type* ptr) const noexcept {
+            void* object = nullptr;
+            if constexpr (std::is_polymorphic_v< Type >) {
+                object = dynamic_cast< void* >(ptr);
+            } else {
+                object = ptr;
+            }
+            ptr->~Type();
+            impl::NodePool::Local().Deallocate(object);
+        }
+    };
+
+    // Constructs a ConstructedType in a pooled node, for small objects created and dropped at a high rate
+    // (enumerators). Type must be ConstructedType or a base of it with a virtual destructor
+    template < class Type, class ConstructedType = Type, class... TArgs >
+    std::unique_ptr< Type, PooledDeleter< Type > > allocate_pooled(TArgs&&... args) {
+        static_assert(std::is_same_v< Type, ConstructedType > || (std::is_base_of_v< Type, ConstructedType > && std::has_virtual_destructor_v< Type >),
+                      "A pooled object must be owned through its own type or a base with a virtual destructor");
+        static_assert(alignof(ConstructedType) <= impl::NodePool::granularity, "Over-aligned types cannot be pooled");
+
+        auto&            pool    = impl::NodePool::Local();
+        void*            storage = pool.Allocate(sizeof(ConstructedType));
+        ConstructedType* ptr     = nullptr;
+        try {
+            ptr = ::new (storage) ConstructedType(std::forward< TArgs >(args)...);
+        } catch (...) {
+            pool.Deallocate(storage);
+            throw;
+        }
+        return std::unique_ptr< Type, PooledDeleter< Type > > { static_cast< Type* >(ptr) };
     }
 
     namespace impl {
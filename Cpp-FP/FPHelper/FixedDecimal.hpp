@@ -0,0 +1,391 @@
+// FixedDecimal.hpp: Fixed-point decimal, an integer count of 10^-Scale units
+//
+// Addition, subtraction and comparison are exact integer operations. Multiplication, division and
+// conversions round with an explicit RoundingMode, operators use banker's rounding (HalfEven) like
+// C# System.Decimal. Operations throw std::overflow_error when a result does not fit the representation
+// and std::domain_error on division by zero.
+// Rep is std::int32_t, std::int64_t or, where the compiler has it, __int128. Products are computed in
+// the next wider integer; without __int128 an int64 product must itself fit in 64 bits, and so must
+// an __int128 product in 128 bits.
+
+#ifndef FIXED_DECIMAL_FP
+#define FIXED_DECIMAL_FP
+
+#include <cmath>
+#include <compare>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+namespace fp {
+
+    enum class RoundingMode {
+        HalfEven,         // to nearest, ties to even (banker's rounding)
+        HalfAwayFromZero, // to nearest, ties away from zero (commercial rounding)
+        TowardZero,       // truncate
+        Up,               // toward +infinity
+        Down              // toward -infinity
+    };
+
+    namespace impl::decimal {
+
+#if defined(__SIZEOF_INT128__)
+        __extension__ using int128 = __int128;
+#endif
+
+        template < class Rep >
+        concept representation = std::same_as< Rep, std::int32_t > || std::same_as< Rep, std::int64_t >
+#if defined(__SIZEOF_INT128__)
+                                 || std::same_as< Rep, int128 >
+#endif
+            ;
+
+        // Integer type products and scaled quotients are computed in, the next wider one when there is one
+        template < class Rep >
+        struct Wider {
+            using type = Rep;
+        };
+        template <>
+        struct Wider< std::int32_t > {
+            using type = std::int64_t;
+        };
+#if defined(__SIZEOF_INT128__)
+        template <>
+        struct Wider< std::int64_t > {
+            using type = int128;
+        };
+#endif
+
+        // std::make_unsigned does not know __int128 in strict ISO mode
+        template < class Rep >
+        struct MakeUnsigned : std::make_unsigned< Rep > {};
+#if defined(__SIZEOF_INT128__)
+        template <>
+        struct MakeUnsigned< int128 > {
+            __extension__ using type = unsigned __int128;
+        };
+#endif
+
+        template < class Rep >
+        inline constexpr Rep max_value = Rep(~(Rep(1) << (sizeof(Rep) * 8 - 1)));
+        template < class Rep >
+        inline constexpr Rep min_value = Rep(-max_value< Rep > - 1);
+
+        template < class Rep >
+        constexpr Rep Pow10(unsigned exponent) {
+            Rep result = 1;
+            for (unsigned i = 0; i < exponent; ++i) { result *= 10; }
+            return result;
+        }
+
+        template < class Rep >
+        constexpr unsigned MaxScale() {
+            unsigned scale = 0;
+            for (Rep value = max_value< Rep >; value >= 10; value /= 10) { ++scale; }
+            return scale;
+        }
+
+        template < class Rep >
+        constexpr Rep Abs(Rep value) noexcept {
+            return value < 0 ? -value : value;
+        }
+
+        // numerator / denominator rounded with mode, both in the same integer type
+        template < class Int >
+        constexpr Int DivideRounded(Int numerator, Int denominator, RoundingMode mode) {
+            if (denominator == 0) throw std::domain_error { "FixedDecimal division by zero" };
+
+            const Int quotient  = numerator / denominator;
+            const Int remainder = numerator % denominator;
+            if (remainder == 0) return quotient;
+
+            // Direction of the exact result relative to the truncated quotient
+            const Int  away     = (remainder < 0) != (denominator < 0) ? Int(-1) : Int(1);
+            const auto absolute = Abs(remainder);
+            const auto rest     = Abs(denominator) - absolute; // distance to the next quotient
+
+            switch (mode) {
+            case RoundingMode::TowardZero: return quotient;
+            case RoundingMode::Up: return away > 0 ? quotient + 1 : quotient;
+            case RoundingMode::Down: return away < 0 ? quotient - 1 : quotient;
+            case RoundingMode::HalfAwayFromZero: return absolute >= rest ? quotient + away : quotient;
+            case RoundingMode::HalfEven:
+            default:
+                if (absolute > rest || (absolute == rest && quotient % 2 != 0)) return quotient + away;
+                return quotient;
+            }
+        }
+
+        template < class Rep, class Int >
+        constexpr Rep Narrow(Int value) {
+            if (value > Int(max_value< Rep >) || value < Int(min_value< Rep >)) throw std::overflow_error { "FixedDecimal overflow" };
+            return static_cast< Rep >(value);
+        }
+
+        // Overflow checked integer operations, true when the result does not fit
+        template < class Int >
+        constexpr bool AddOverflow(Int lhs, Int rhs, Int* result) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+            return __builtin_add_overflow(lhs, rhs, result);
+#else
+            if ((rhs > 0 && lhs > max_value< Int > - rhs) || (rhs < 0 && lhs < min_value< Int > - rhs)) return true;
+            *result = lhs + rhs;
+            return false;
+#endif
+        }
+
+        template < class Int >
+        constexpr bool SubOverflow(Int lhs, Int rhs, Int* result) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+            return __builtin_sub_overflow(lhs, rhs, result);
+#else
+            if ((rhs < 0 && lhs > max_value< Int > + rhs) || (rhs > 0 && lhs < min_value< Int > + rhs)) return true;
+            *result = lhs - rhs;
+            return false;
+#endif
+        }
+
+        template < class Int >
+        constexpr bool MulOverflow(Int lhs, Int rhs, Int* result) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+            return __builtin_mul_overflow(lhs, rhs, result);
+#else
+            using Unsigned           = typename MakeUnsigned< Int >::type;
+            const Unsigned magnitude = lhs < 0 ? Unsigned(0) - Unsigned(lhs) : Unsigned(lhs);
+            const Unsigned factor    = rhs < 0 ? Unsigned(0) - Unsigned(rhs) : Unsigned(rhs);
+            const Unsigned limit     = (lhs < 0) != (rhs < 0) ? Unsigned(max_value< Int >) + 1 : Unsigned(max_value< Int >);
+            if (factor != 0 && magnitude > limit / factor) return true;
+            *result = static_cast< Int >(Unsigned(lhs) * Unsigned(rhs));
+            return false;
+#endif
+        }
+
+        template < class Int >
+        constexpr Int CheckedMultiply(Int lhs, Int rhs) {
+            Int result {};
+            if (MulOverflow(lhs, rhs, &result)) throw std::overflow_error { "FixedDecimal overflow" };
+            return result;
+        }
+
+    } // namespace impl::decimal
+
+    /// <summary>
+    /// Decimal number stored as Rep units of 10^-Scale, e.g. FixedDecimal< 4 > holds 12.3456 as 123456.
+    /// Trivially copyable and as large as Rep, a column of them sums with plain integer adds.
+    /// </summary>
+    template < unsigned Scale, impl::decimal::representation Rep = std::int64_t >
+    class FixedDecimal {
+        using Wide = typename impl::decimal::Wider< Rep >::type;
+
+      public:
+        using rep_type                     = Rep;
+        static constexpr unsigned scale    = Scale;
+        static constexpr Rep      one      = impl::decimal::Pow10< Rep >(Scale);
+        static constexpr auto     rounding = RoundingMode::HalfEven;
+
+        static_assert(Scale <= impl::decimal::MaxScale< Rep >(), "10^Scale does not fit in the representation");
+
+        constexpr FixedDecimal() noexcept = default;
+        // Integers convert exactly (and implicitly, so Type(0) and literals work as with other arithmetic types)
+        template < std::integral Integer >
+        constexpr FixedDecimal(Integer value) : units(impl::decimal::Narrow< Rep >(impl::decimal::CheckedMultiply(static_cast< Wide >(value), Wide(one)))) {}
+        template < std::floating_point Floating >
+        explicit FixedDecimal(Floating value) : FixedDecimal(FromFloating(value, rounding)) {}
+
+        [[nodiscard]] static constexpr FixedDecimal FromUnits(Rep units_) noexcept {
+            FixedDecimal result {};
+            result.units = units_;
+            return result;
+        }
+
+        template < std::floating_point Floating >
+        [[nodiscard]] static FixedDecimal FromFloating(Floating value, RoundingMode mode) {
+            const long double scaled   = static_cast< long double >(value) * one;
+            const long double whole    = std::trunc(scaled);
+            const long double fraction = scaled - whole;
+            if (!std::isfinite(scaled) || whole > static_cast< long double >(impl::decimal::max_value< Rep >) ||
+                whole < static_cast< long double >(impl::decimal::min_value< Rep >))
+                throw std::overflow_error { "FixedDecimal overflow" };
+
+            auto       result  = static_cast< Rep >(whole);
+            const auto away    = fraction < 0 ? Rep(-1) : Rep(1);
+            const auto half    = std::fabs(fraction) == 0.5L;
+            const auto further = std::fabs(fraction) > 0.5L;
+            if (fraction != 0) {
+                switch (mode) {
+                case RoundingMode::TowardZero: break;
+                case RoundingMode::Up: result += away > 0 ? 1 : 0; break;
+                case RoundingMode::Down: result -= away < 0 ? 1 : 0; break;
+                case RoundingMode::HalfAwayFromZero: result += further || half ? away : 0; break;
+                case RoundingMode::HalfEven:
+                default: result += further || (half && result % 2 != 0) ? away : 0; break;
+                }
+            }
+            return FromUnits(result);
+        }
+
+        // Units of 10^-Scale
+        [[nodiscard]] constexpr Rep Units() const noexcept { return units; }
+
+        template < std::floating_point Floating >
+        explicit constexpr operator Floating() const noexcept {
+            return static_cast< Floating >(units) / static_cast< Floating >(one);
+        }
+
+        // Changes the number of decimals, rounding when some are dropped
+        template < unsigned NewScale >
+        [[nodiscard]] constexpr FixedDecimal< NewScale, Rep > Rescale(RoundingMode mode = rounding) const {
+            if constexpr (NewScale >= Scale) {
+                return FixedDecimal< NewScale, Rep >::FromUnits(
+                    impl::decimal::Narrow< Rep >(impl::decimal::CheckedMultiply(Wide(units), Wide(impl::decimal::Pow10< Rep >(NewScale - Scale)))));
+            } else {
+                return FixedDecimal< NewScale, Rep >::FromUnits(impl::decimal::DivideRounded(units, impl::decimal::Pow10< Rep >(Scale - NewScale), mode));
+            }
+        }
+
+        [[nodiscard]] static constexpr FixedDecimal Multiply(FixedDecimal lhs, FixedDecimal rhs, RoundingMode mode) {
+            const auto product = impl::decimal::CheckedMultiply(Wide(lhs.units), Wide(rhs.units));
+            return FromUnits(impl::decimal::Narrow< Rep >(impl::decimal::DivideRounded(product, Wide(one), mode)));
+        }
+
+        [[nodiscard]] static constexpr FixedDecimal Divide(FixedDecimal lhs, FixedDecimal rhs, RoundingMode mode) {
+            const auto numerator = impl::decimal::CheckedMultiply(Wide(lhs.units), Wide(one));
+            return FromUnits(impl::decimal::Narrow< Rep >(impl::decimal::DivideRounded(numerator, Wide(rhs.units), mode)));
+        }
+
+        template < std::integral Integer >
+        [[nodiscard]] static constexpr FixedDecimal Divide(FixedDecimal lhs, Integer rhs, RoundingMode mode) {
+            using Common = std::conditional_t< (sizeof(Integer) >= sizeof(Rep)), Wide, Rep >;
+            if constexpr (std::is_unsigned_v< Integer >) {
+                if (rhs > static_cast< typename impl::decimal::MakeUnsigned< Common >::type >(impl::decimal::max_value< Common >)) return FromUnits(0);
+            }
+            return FromUnits(impl::decimal::Narrow< Rep >(impl::decimal::DivideRounded(Common(lhs.units), static_cast< Common >(rhs), mode)));
+        }
+
+        constexpr FixedDecimal& operator+=(FixedDecimal rhs) {
+            if (impl::decimal::AddOverflow(units, rhs.units, &units)) throw std::overflow_error { "FixedDecimal overflow" };
+            return *this;
+        }
+        constexpr FixedDecimal& operator-=(FixedDecimal rhs) {
+            if (impl::decimal::SubOverflow(units, rhs.units, &units)) throw std::overflow_error { "FixedDecimal overflow" };
+            return *this;
+        }
+        constexpr FixedDecimal& operator*=(FixedDecimal rhs) { return *this = Multiply(*this, rhs, rounding); }
+        constexpr FixedDecimal& operator/=(FixedDecimal rhs) { return *this = Divide(*this, rhs, rounding); }
+
+        [[nodiscard]] friend constexpr FixedDecimal operator+(FixedDecimal lhs, FixedDecimal rhs) { return lhs += rhs; }
+        [[nodiscard]] friend constexpr FixedDecimal operator-(FixedDecimal lhs, FixedDecimal rhs) { return lhs -= rhs; }
+        [[nodiscard]] friend constexpr FixedDecimal operator-(FixedDecimal value) { return FixedDecimal {} - value; }
+        [[nodiscard]] friend constexpr FixedDecimal operator*(FixedDecimal lhs, FixedDecimal rhs) { return Multiply(lhs, rhs, rounding); }
+        [[nodiscard]] friend constexpr FixedDecimal operator/(FixedDecimal lhs, FixedDecimal rhs) { return Divide(lhs, rhs, rounding); }
+        // Averages divide a sum by an element count
+        template < std::integral Integer >
+        [[nodiscard]] friend constexpr FixedDecimal operator/(FixedDecimal lhs, Integer rhs) {
+            return Divide(lhs, rhs, rounding);
+        }
+
+        friend constexpr auto operator<=>(const FixedDecimal&, const FixedDecimal&) = default;
+
+        [[nodiscard]] std::string ToString() const {
+            using Unsigned = typename impl::decimal::MakeUnsigned< Rep >::type;
+            // Magnitude as unsigned, which also holds the minimum value
+            auto magnitude = units < 0 ? Unsigned(0) - static_cast< Unsigned >(units) : static_cast< Unsigned >(units);
+
+            std::string digits {};
+            for (unsigned position = 0; magnitude != 0 || position <= Scale; ++position) {
+                if (position == Scale && Scale != 0) digits.insert(digits.begin(), '.');
+                digits.insert(digits.begin(), static_cast< char >('0' + static_cast< int >(magnitude % 10)));
+                magnitude /= 10;
+            }
+            if (units < 0) digits.insert(digits.begin(), '-');
+            return digits;
+        }
+
+        friend std::ostream& operator<<(std::ostream& stream, const FixedDecimal& value) { return stream << value.ToString(); }
+
+      private:
+        Rep units = 0;
+    };
+
+    namespace decimal_kernels {
+
+        /// <summary>
+        /// Exact column sum without a per element overflow check, so the loop vectorizes:
+        /// int32 units are accumulated in int64 lanes, int64 units are split in 32 bits halves accumulated
+        /// in 64 bits lanes (exact up to 2^32 elements per lane) and recombined in the wide type once.
+        /// Throws std::overflow_error when the total does not fit.
+        /// </summary>
+        template < unsigned Scale, class Rep >
+        [[nodiscard]] FixedDecimal< Scale, Rep > Sum(std::span< const FixedDecimal< Scale, Rep > > values) {
+            using Wide           = typename impl::decimal::Wider< Rep >::type;
+            constexpr auto lanes = std::size_t(4);
+
+            Wide total = 0;
+            if constexpr (sizeof(Rep) == 4) {
+                std::int64_t accumulators[lanes] {};
+                std::size_t  i = 0;
+                for (; i + lanes <= values.size(); i += lanes) {
+                    for (std::size_t lane = 0; lane < lanes; ++lane) { accumulators[lane] += values[i + lane].Units(); }
+                }
+                for (; i < values.size(); ++i) { accumulators[0] += values[i].Units(); }
+                for (const auto accumulator : accumulators) { total += accumulator; }
+            } else if constexpr (sizeof(Rep) == 8) {
+                std::uint64_t low[lanes] {};
+                std::int64_t  high[lanes] {};
+                std::size_t   i = 0;
+                for (; i + lanes <= values.size(); i += lanes) {
+                    for (std::size_t lane = 0; lane < lanes; ++lane) {
+                        low[lane] += static_cast< std::uint64_t >(values[i + lane].Units()) & 0xFFFFFFFFu;
+                        high[lane] += values[i + lane].Units() >> 32;
+                    }
+                }
+                for (; i < values.size(); ++i) {
+                    low[0] += static_cast< std::uint64_t >(values[i].Units()) & 0xFFFFFFFFu;
+                    high[0] += values[i].Units() >> 32;
+                }
+                for (std::size_t lane = 0; lane < lanes; ++lane) {
+                    Wide part {};
+                    if (impl::decimal::MulOverflow(Wide(high[lane]), Wide(std::int64_t(1) << 32), &part) || impl::decimal::AddOverflow(total, part, &total) ||
+                        impl::decimal::AddOverflow(total, Wide(low[lane]), &total))
+                        throw std::overflow_error { "FixedDecimal overflow" };
+                }
+            } else {
+                for (const auto& value : values) {
+                    if (impl::decimal::AddOverflow(total, value.Units(), &total)) throw std::overflow_error { "FixedDecimal overflow" };
+                }
+            }
+            return FixedDecimal< Scale, Rep >::FromUnits(impl::decimal::Narrow< Rep >(total));
+        }
+
+        // Exact sum divided once by the count, an empty column averages to zero
+        template < unsigned Scale, class Rep >
+        [[nodiscard]] FixedDecimal< Scale, Rep > Average(std::span< const FixedDecimal< Scale, Rep > > values, RoundingMode mode = RoundingMode::HalfEven) {
+            if (values.empty()) return {};
+            return FixedDecimal< Scale, Rep >::Divide(Sum(values), values.size(), mode);
+        }
+
+        // out[i] = lhs[i] + rhs[i], out must hold at least lhs.size() elements
+        template < unsigned Scale, class Rep >
+        void Add(std::span< const FixedDecimal< Scale, Rep > > lhs, std::span< const FixedDecimal< Scale, Rep > > rhs,
+                 std::span< FixedDecimal< Scale, Rep > > out) {
+            if (rhs.size() < lhs.size() || out.size() < lhs.size()) throw std::length_error { "Add expects columns of the same size" };
+            bool overflow = false;
+            for (std::size_t i = 0; i < lhs.size(); ++i) {
+                Rep sum {};
+                overflow |= impl::decimal::AddOverflow(lhs[i].Units(), rhs[i].Units(), &sum);
+                out[i] = FixedDecimal< Scale, Rep >::FromUnits(sum);
+            }
+            if (overflow) throw std::overflow_error { "FixedDecimal overflow" };
+        }
+
+    } // namespace decimal_kernels
+
+} // namespace fp
+
+#endif // FIXED_DECIMAL_FP
@@ -0,0 +1,508 @@
+// FlatHashMap.hpp: Open-addressing hash containers
+//
+// Entries live in one dense array in insertion order, a power of two table of buckets maps hashes to positions
+// in that array. Buckets are probed in groups of sixteen through one control byte each (an SSE2 compare per group
+// where available), iteration walks the dense array and nothing is allocated per entry. The containers are built
+// and queried, entries are never erased.
+
+#ifndef FLAT_HASH_MAP_FP
+#define FLAT_HASH_MAP_FP
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <Execution.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64)
+    #include <immintrin.h>
+#endif
+
+namespace fp {
+
+    namespace impl {
+        // Murmur3 finalizer: every bit of the input reaches every bit of the result, std::hash of an integer is the integer
+        [[nodiscard]] constexpr std::uint64_t MixHash(std::uint64_t hash) noexcept {
+            hash ^= hash >> 33;
+            hash *= 0xff51afd7ed558ccdULL;
+            hash ^= hash >> 33;
+            hash *= 0xc4ceb9fe1a85ec53ULL;
+            hash ^= hash >> 33;
+            return hash;
+        }
+
+        template < class Hash, class Key >
+        [[nodiscard]] std::uint64_t MixedHash(const Hash& hash, const Key& key) {
+            return MixHash(static_cast< std::uint64_t >(hash(key)));
+        }
+
+        // Sixteen control bytes of a FlatIndex group: empty, or the low 7 bits of the hash in the bucket.
+        // Match returns one bit per byte equal to the argument, one SSE2 compare where available
+        struct ControlGroup {
+            static constexpr std::size_t width = 16;
+            static constexpr std::int8_t empty = -128;
+
+#if defined(__SSE2__) || defined(_M_X64)
+            explicit ControlGroup(const std::int8_t* control) noexcept : bytes(_mm_loadu_si128(reinterpret_cast< const __m128i* >(control))) {}
+
+            [[nodiscard]] std::uint32_t Match(std::int8_t value) const noexcept {
+                return static_cast< std::uint32_t >(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(value))));
+            }
+
+          private:
+            __m128i bytes;
+#else
+            explicit ControlGroup(const std::int8_t* control) noexcept : bytes(control) {}
+
+            [[nodiscard]] std::uint32_t Match(std::int8_t value) const noexcept {
+                std::uint32_t mask = 0;
+                for (std::size_t i = 0; i < width; ++i) { mask |= static_cast< std::uint32_t >(bytes[i] == value) << i; }
+                return mask;
+            }
+
+          private:
+            const std::int8_t* bytes;
+#endif
+        };
+
+        /// <summary>
+        /// Open-addressing table from hashes to positions in a dense array owned by the caller
+        /// Buckets are probed sixteen at a time through their control bytes, so probe lengths stay short and
+        /// predictable up to 7/8 full. The whole hash is kept in the bucket, keys are only compared on a hash match
+        /// </summary>
+        template < class Allocator = std::allocator< std::byte > >
+        class FlatIndex {
+          public:
+            using size_type = std::size_t;
+
+            static constexpr size_type npos = static_cast< size_type >(-1);
+
+            explicit FlatIndex(const Allocator& alloc = Allocator {}) : controls(ControlAllocator(alloc)), buckets(BucketAllocator(alloc)) {}
+
+            // Room for count positions without growing
+            void reserve(size_type count_) {
+                if (count_ > Capacity()) Rehash(BucketsFor(count_));
+            }
+
+            [[nodiscard]] size_type size() const noexcept { return count; }
+
+            // Position with this hash for which matches(position) holds, npos if there is none
+            template < class Matches >
+            [[nodiscard]] size_type Find(std::uint64_t hash, Matches&& matches) const {
+                if (buckets.empty()) return npos;
+                for (auto [group, step] = std::pair { GroupOf(hash), size_type { 0 } };; group = (group + ++step) & groupMask) {
+                    const ControlGroup control { controls.data() + group * ControlGroup::width };
+                    if (const auto position = FindInGroup(control, group, hash, matches); position != npos) return position;
+                    if (control.Match(ControlGroup::empty) != 0) return npos;
+                }
+            }
+
+            // The matching position and false, or position itself and true after adding it when nothing matches.
+            // Never allocates while reserve() made room for one more position
+            template < class Matches >
+            std::pair< size_type, bool > FindOrInsert(std::uint64_t hash, size_type position, Matches&& matches) {
+                if (count == Capacity()) Rehash(BucketsFor(count + 1));
+                for (auto [group, step] = std::pair { GroupOf(hash), size_type { 0 } };; group = (group + ++step) & groupMask) {
+                    const ControlGroup control { controls.data() + group * ControlGroup::width };
+                    if (const auto found = FindInGroup(control, group, hash, matches); found != npos) return { found, false };
+                    if (const auto empty = control.Match(ControlGroup::empty); empty != 0) {
+                        Fill(group * ControlGroup::width + static_cast< size_type >(std::countr_zero(empty)), Bucket { hash, position });
+                        ++count;
+                        return { position, true };
+                    }
+                }
+            }
+
+            // Adds a position that is known not to match any other
+            void Insert(std::uint64_t hash, size_type position) {
+                if (count == Capacity()) Rehash(BucketsFor(count + 1));
+                Place(Bucket { hash, position });
+                ++count;
+            }
+
+          private:
+            struct Bucket {
+                std::uint64_t hash     = 0;
+                size_type     position = npos;
+            };
+            using ControlAllocator = typename std::allocator_traits< Allocator >::template rebind_alloc< std::int8_t >;
+            using BucketAllocator  = typename std::allocator_traits< Allocator >::template rebind_alloc< Bucket >;
+
+            [[nodiscard]] size_type Capacity() const noexcept { return buckets.size() - buckets.size() / 8; }
+
+            [[nodiscard]] static size_type BucketsFor(size_type count_) noexcept {
+                size_type bucketCount = ControlGroup::width;
+                while (bucketCount - bucketCount / 8 < count_) { bucketCount *= 2; }
+                return bucketCount;
+            }
+
+            // Groups come from the high bits of the hash, the control byte from the low 7
+            [[nodiscard]] size_type GroupOf(std::uint64_t hash) const noexcept { return static_cast< size_type >(hash >> 7) & groupMask; }
+            [[nodiscard]] static std::int8_t Fingerprint(std::uint64_t hash) noexcept { return static_cast< std::int8_t >(hash & 0x7F); }
+
+            template < class Matches >
+            [[nodiscard]] size_type FindInGroup(const ControlGroup& control, size_type group, std::uint64_t hash, Matches& matches) const {
+                for (auto candidates = control.Match(Fingerprint(hash)); candidates != 0; candidates &= candidates - 1) {
+                    const auto& entry = buckets[group * ControlGroup::width + static_cast< size_type >(std::countr_zero(candidates))];
+                    if (entry.hash == hash && matches(entry.position)) return entry.position;
+                }
+                return npos;
+            }
+
+            void Fill(size_type bucket, const Bucket& entry) noexcept {
+                controls[bucket] = Fingerprint(entry.hash);
+                buckets[bucket]  = entry;
+            }
+
+            void Place(const Bucket& entry) noexcept {
+                for (auto [group, step] = std::pair { GroupOf(entry.hash), size_type { 0 } };; group = (group + ++step) & groupMask) {
+                    if (const auto empty = ControlGroup { controls.data() + group * ControlGroup::width }.Match(ControlGroup::empty); empty != 0) {
+                        Fill(group * ControlGroup::width + static_cast< size_type >(std::countr_zero(empty)), entry);
+                        return;
+                    }
+                }
+            }
+
+            void Rehash(size_type bucketCount) {
+                std::vector< Bucket, BucketAllocator > previous(bucketCount, Bucket {}, buckets.get_allocator());
+                controls.assign(bucketCount, ControlGroup::empty);
+                previous.swap(buckets);
+                groupMask = bucketCount / ControlGroup::width - 1;
+                for (const auto& entry : previous) {
+                    if (entry.position != npos) Place(entry);
+                }
+            }
+
+            std::vector< std::int8_t, ControlAllocator > controls;
+            std::vector< Bucket, BucketAllocator >       buckets;
+            size_type                                    groupMask = 0;
+            size_type                                    count     = 0;
+        };
+
+        /// <summary>
+        /// Positions [0, count) split by the top bits of their hash into a power of two number of partitions
+        /// order lists the positions partition by partition, every partition in ascending order
+        /// </summary>
+        template < class Allocator >
+        struct HashPartitions {
+            using size_type = std::size_t;
+            template < class Other >
+            using Rebind = typename std::allocator_traits< Allocator >::template rebind_alloc< Other >;
+
+            std::vector< std::uint64_t, Rebind< std::uint64_t > > hashes;
+            std::vector< size_type, Rebind< size_type > >         order;
+            // Partition p is order[offsets[p], offsets[p + 1])
+            std::vector< size_type, Rebind< size_type > > offsets;
+
+            [[nodiscard]] size_type Count() const noexcept { return offsets.size() - 1; }
+            [[nodiscard]] size_type Size(size_type partition) const noexcept { return offsets[partition + 1] - offsets[partition]; }
+
+            [[nodiscard]] size_type PartitionOf(std::uint64_t hash) const noexcept {
+                return Count() == 1 ? 0 : static_cast< size_type >(hash >> (64 - std::countr_zero(Count())));
+            }
+
+            // One table per partition with room for all of its positions, filling them in parallel never allocates
+            [[nodiscard]] auto Tables() const {
+                using Table = FlatIndex< Allocator >;
+                std::vector< Table, Rebind< Table > > tables(Rebind< Table >(hashes.get_allocator()));
+                tables.reserve(Count());
+                for (size_type partition = 0; partition < Count(); ++partition) {
+                    tables.emplace_back(Allocator(hashes.get_allocator())).reserve(Size(partition));
+                }
+                return tables;
+            }
+        };
+
+        // Hashes every position with hashOf and scatters the positions into one partition per chunk (rounded up to a
+        // power of two). Chunks run in parallel, memory is only allocated on the calling thread
+        template < class Allocator, class HashOf >
+        [[nodiscard]] HashPartitions< Allocator > PartitionByHash(std::size_t count, std::size_t chunks, HashOf&& hashOf, const Allocator& alloc) {
+            using Partitions = HashPartitions< Allocator >;
+            using Sizes      = std::vector< std::size_t, typename Partitions::template Rebind< std::size_t > >;
+
+            const auto partitionCount = std::bit_ceil(chunks);
+            Partitions partitions { { count, 0, alloc }, { count, 0, alloc }, { partitionCount + 1, 0, alloc } };
+
+            // counts[chunk * partitionCount + partition] becomes where the chunk writes its first position of the partition
+            Sizes counts(chunks * partitionCount, 0, alloc);
+            ParallelChunks(count, chunks, [&](std::size_t chunk, std::size_t first, std::size_t last) {
+                for (auto position = first; position < last; ++position) {
+                    partitions.hashes[position] = hashOf(position);
+                    ++counts[chunk * partitionCount + partitions.PartitionOf(partitions.hashes[position])];
+                }
+            });
+
+            std::size_t total = 0;
+            for (std::size_t partition = 0; partition < partitionCount; ++partition) {
+                partitions.offsets[partition] = total;
+                for (std::size_t chunk = 0; chunk < chunks; ++chunk) { total += std::exchange(counts[chunk * partitionCount + partition], total); }
+            }
+            partitions.offsets[partitionCount] = total;
+
+            ParallelChunks(count, chunks, [&](std::size_t chunk, std::size_t first, std::size_t last) {
+                auto* next = counts.data() + chunk * partitionCount;
+                for (auto position = first; position < last; ++position) { partitions.order[next[partitions.PartitionOf(partitions.hashes[position])]++] = position; }
+            });
+            return partitions;
+        }
+    } // namespace impl
+
+    /// <summary>
+    /// Dictionary on an open-addressing table, iterated in insertion order
+    /// Iterators and references stay valid until the next insertion
+    /// </summary>
+    template < class Key, class Value, class Hash = std::hash< Key >, class KeyEqual = std::equal_to< Key >,
+               class Allocator = std::allocator< std::pair< Key, Value > > >
+    class FlatHashMap {
+      public:
+        using key_type       = Key;
+        using mapped_type    = Value;
+        using value_type     = std::pair< Key, Value >;
+        using size_type      = std::size_t;
+        using hasher         = Hash;
+        using key_equal      = KeyEqual;
+        using allocator_type = Allocator;
+        using const_iterator = typename std::vector< value_type, Allocator >::const_iterator;
+
+        explicit FlatHashMap(size_type expected = 0, const Hash& hash_ = Hash {}, const KeyEqual& equal_ = KeyEqual {}, const Allocator& alloc = Allocator {}) :
+            index(alloc), entries(alloc), hash(hash_), equal(equal_) {
+            reserve(expected);
+        }
+        explicit FlatHashMap(const Allocator& alloc) : FlatHashMap(0, Hash {}, KeyEqual {}, alloc) {}
+
+        [[nodiscard]] allocator_type get_allocator() const noexcept { return entries.get_allocator(); }
+
+        void reserve(size_type count) {
+            index.reserve(count);
+            entries.reserve(count);
+        }
+
+        // Returns false and leaves the map unchanged when the key is already present
+        bool TryAdd(Key key, Value value) { return TryEmplace(std::move(key), std::move(value)).second; }
+
+        // Value of key and whether it was constructed from args, as std::unordered_map::try_emplace
+        template < class... Args >
+        std::pair< Value&, bool > TryEmplace(Key key, Args&&... args) {
+            const auto keyHash = impl::MixedHash(hash, key);
+            if (const auto position = FindPosition(keyHash, key); position != npos) return { entries[position].second, false };
+
+            entries.emplace_back(std::piecewise_construct, std::forward_as_tuple(std::move(key)), std::forward_as_tuple(std::forward< Args >(args)...));
+            try {
+                index.Insert(keyHash, entries.size() - 1);
+            } catch (...) {
+                entries.pop_back();
+                throw;
+            }
+            return { entries.back().second, true };
+        }
+
+        Value& operator[](const Key& key) { return TryEmplace(key).first; }
+
+        [[nodiscard]] const Value* Find(const Key& key) const {
+            const auto position = FindPosition(impl::MixedHash(hash, key), key);
+            return position != npos ? &entries[position].second : nullptr;
+        }
+        [[nodiscard]] Value* Find(const Key& key) { return const_cast< Value* >(std::as_const(*this).Find(key)); }
+
+        [[nodiscard]] Value FindOrDefault(const Key& key) const {
+            const auto* value = Find(key);
+            return value != nullptr ? *value : Value {};
+        }
+
+        [[nodiscard]] const Value& at(const Key& key) const {
+            const auto* value = Find(key);
+            if (value == nullptr) throw std::out_of_range { "Key is not in the dictionary" };
+            return *value;
+        }
+        [[nodiscard]] Value& at(const Key& key) { return const_cast< Value& >(std::as_const(*this).at(key)); }
+
+        [[nodiscard]] bool      contains(const Key& key) const { return Find(key) != nullptr; }
+        [[nodiscard]] size_type size() const noexcept { return entries.size(); }
+        [[nodiscard]] bool      empty() const noexcept { return entries.empty(); }
+
+        [[nodiscard]] const_iterator begin() const noexcept { return entries.begin(); }
+        [[nodiscard]] const_iterator end() const noexcept { return entries.end(); }
+
+      private:
+        static constexpr size_type npos = impl::FlatIndex< Allocator >::npos;
+
+        [[nodiscard]] size_type FindPosition(std::uint64_t keyHash, const Key& key) const {
+            return index.Find(keyHash, [&](size_type position) { return equal(entries[position].first, key); });
+        }
+
+        impl::FlatIndex< Allocator >         index;
+        std::vector< value_type, Allocator > entries;
+        [[no_unique_address]] Hash           hash;
+        [[no_unique_address]] KeyEqual       equal;
+    };
+
+    /// <summary>
+    /// One-to-many lookup on an open-addressing table, built once: the hashed counterpart of EnumLookup
+    /// Keys are numbered in order of first appearance, the values of a key are contiguous and in source order
+    /// </summary>
+    template < class Key, class Value, class Hash = std::hash< Key >, class KeyEqual = std::equal_to< Key >, class Allocator = std::allocator< Value > >
+    class FlatLookup {
+      public:
+        using key_type    = Key;
+        using mapped_type = Value;
+        using size_type   = std::size_t;
+
+        static constexpr size_type npos = impl::FlatIndex< Allocator >::npos;
+
+        explicit FlatLookup(const Allocator& alloc = Allocator {}) : index(alloc), keys(KeyAllocator(alloc)), offsets(1, 0, SizeAllocator(alloc)), values(alloc) {}
+
+        // One pass to number the keys and count their values, one to place the values
+        template < std::ranges::forward_range Range, class KeySelector, class ValueSelector >
+        FlatLookup(const Range& elements, KeySelector&& keySelector, ValueSelector&& valueSelector, const Allocator& alloc = Allocator {}) : FlatLookup(alloc) {
+            Build(elements, keySelector, valueSelector);
+        }
+
+        // With execution::par the keys are hashed in parallel and the elements partitioned by hash,
+        // every partition finds its own keys. Only the numbering of the keys is sequential
+        template < execution::execution_policy Policy, std::ranges::random_access_range Range, class KeySelector, class ValueSelector >
+        requires std::ranges::sized_range< Range >
+        FlatLookup(Policy&& policy, const Range& elements, KeySelector&& keySelector, ValueSelector&& valueSelector, const Allocator& alloc = Allocator {}) :
+            FlatLookup(alloc) {
+            if constexpr (std::is_same_v< std::remove_cvref_t< Policy >, execution::sequenced_policy >) {
+                Build(elements, keySelector, valueSelector);
+            } else if (const auto chunks = impl::ChunkCount(std::ranges::size(elements), policy.grain_size); chunks == 1) {
+                Build(elements, keySelector, valueSelector);
+            } else {
+                BuildPartitioned(chunks, elements, keySelector, valueSelector);
+            }
+        }
+
+        // Values of key, empty when the key has none
+        [[nodiscard]] std::span< const Value > operator[](const Key& key) const {
+            const auto group = IndexOf(key);
+            return group != npos ? Group(group) : std::span< const Value > {};
+        }
+
+        [[nodiscard]] std::span< const Value > at(const Key& key) const {
+            const auto group = IndexOf(key);
+            if (group == npos) throw std::out_of_range { "Key is not in the lookup" };
+            return Group(group);
+        }
+
+        // Number of the key in order of first appearance, npos when the key has no values
+        [[nodiscard]] size_type IndexOf(const Key& key) const {
+            return index.Find(impl::MixedHash(hash, key), [&](size_type group) { return equal(keys[group], key); });
+        }
+        [[nodiscard]] std::span< const Value > Group(size_type group) const noexcept {
+            return { values.data() + offsets[group], offsets[group + 1] - offsets[group] };
+        }
+        [[nodiscard]] std::span< const Key > Keys() const noexcept { return keys; }
+
+        [[nodiscard]] bool      contains(const Key& key) const { return IndexOf(key) != npos; }
+        [[nodiscard]] size_type GroupCount() const noexcept { return keys.size(); }
+        [[nodiscard]] size_type size() const noexcept { return values.size(); }
+
+      private:
+        using KeyAllocator  = typename std::allocator_traits< Allocator >::template rebind_alloc< Key >;
+        using SizeAllocator = typename std::allocator_traits< Allocator >::template rebind_alloc< size_type >;
+        using Sizes         = std::vector< size_type, SizeAllocator >;
+
+        template < class Range, class KeySelector, class ValueSelector >
+        void Build(const Range& elements, KeySelector& keySelector, ValueSelector& valueSelector) {
+            Sizes groupOf(offsets.get_allocator());
+            if constexpr (std::ranges::sized_range< Range >) groupOf.reserve(std::ranges::size(elements));
+
+            for (const auto& element : elements) {
+                const Key& key            = std::invoke(keySelector, element);
+                const auto [group, added] = index.FindOrInsert(impl::MixedHash(hash, key), keys.size(), [&](size_type candidate) { return equal(keys[candidate], key); });
+                if (added) {
+                    keys.push_back(key);
+                    offsets.push_back(0);
+                }
+                ++offsets[group + 1];
+                groupOf.push_back(group);
+            }
+            std::inclusive_scan(offsets.begin(), offsets.end(), offsets.begin());
+
+            // Element of every value, then the values are constructed from them in that order
+            using Element          = std::remove_cvref_t< std::ranges::range_reference_t< const Range > >;
+            using ElementAllocator = typename std::allocator_traits< Allocator >::template rebind_alloc< const Element* >;
+            std::vector< const Element*, ElementAllocator > ordered(groupOf.size(), nullptr, ElementAllocator(values.get_allocator()));
+            auto                                            next  = offsets;
+            auto                                            group = groupOf.begin();
+            for (const auto& element : elements) { ordered[next[*group++]++] = &element; }
+
+            values.reserve(ordered.size());
+            for (const auto* element : ordered) { values.emplace_back(std::invoke(valueSelector, *element)); }
+        }
+
+        template < class Range, class KeySelector, class ValueSelector >
+        void BuildPartitioned(std::size_t chunks, const Range& elements, KeySelector& keySelector, ValueSelector& valueSelector) {
+            const auto count = static_cast< size_type >(std::ranges::size(elements));
+            const auto first = std::ranges::begin(elements);
+            const auto keyAt = [&](size_type position) -> decltype(auto) { return std::invoke(keySelector, first[position]); };
+
+            auto partitions = impl::PartitionByHash(
+                count, chunks, [&](size_type position) { return impl::MixedHash(hash, static_cast< const Key& >(keyAt(position))); }, values.get_allocator());
+            auto tables = partitions.Tables();
+
+            // The first element of every key stands for the key: groupOf maps each element to it, sizes counts its values
+            Sizes groupOf(count, 0, offsets.get_allocator());
+            Sizes sizes(count, 0, offsets.get_allocator());
+            impl::ParallelFor(partitions.Count(), [&](size_type partition) {
+                for (auto slot = partitions.offsets[partition]; slot < partitions.offsets[partition + 1]; ++slot) {
+                    const auto position   = partitions.order[slot];
+                    const Key& key        = keyAt(position);
+                    const auto matches    = [&](size_type candidate) { return equal(static_cast< const Key& >(keyAt(candidate)), key); };
+                    const auto firstOfKey = tables[partition].FindOrInsert(partitions.hashes[position], position, matches).first;
+                    groupOf[position]     = firstOfKey;
+                    ++sizes[firstOfKey];
+                }
+            });
+
+            // Keys numbered in order of first appearance, sizes becomes where the values of each key start
+            for (size_type position = 0; position < count; ++position) {
+                if (groupOf[position] != position) continue;
+                index.Insert(partitions.hashes[position], keys.size());
+                keys.push_back(keyAt(position));
+                offsets.push_back(offsets.back() + sizes[position]);
+                sizes[position] = offsets[offsets.size() - 2];
+            }
+
+            // Every partition places its elements in source order, and so the values of each of its keys
+            Sizes ordered(count, 0, offsets.get_allocator());
+            impl::ParallelFor(partitions.Count(), [&](size_type partition) {
+                for (auto slot = partitions.offsets[partition]; slot < partitions.offsets[partition + 1]; ++slot) {
+                    const auto position                 = partitions.order[slot];
+                    ordered[sizes[groupOf[position]]++] = position;
+                }
+            });
+
+            if constexpr (std::is_default_constructible_v< Value > && std::is_move_assignable_v< Value >) {
+                values.resize(count);
+                impl::ParallelChunks(count, chunks, [&](std::size_t, std::size_t begin, std::size_t end) {
+                    for (auto slot = begin; slot < end; ++slot) { values[slot] = std::invoke(valueSelector, first[ordered[slot]]); }
+                });
+            } else {
+                values.reserve(count);
+                for (const auto position : ordered) { values.emplace_back(std::invoke(valueSelector, first[position])); }
+            }
+        }
+
+        impl::FlatIndex< Allocator >     index;
+        std::vector< Key, KeyAllocator > keys;
+        // Values of group g are values[offsets[g], offsets[g + 1])
+        Sizes                           offsets;
+        std::vector< Value, Allocator > values;
+        [[no_unique_address]] Hash      hash {};
+        [[no_unique_address]] KeyEqual  equal {};
+    };
+
+} // namespace fp
+
+#endif // FLAT_HASH_MAP_FP
@@ -0,0 +1,149 @@
+// InplaceFunction.hpp: Move-only type-erased callable with a fixed inline buffer
+//
+// Unlike std::function it never allocates: a callable that does not fit in Capacity bytes
+// is rejected at compile time. A noexcept signature (R(Args...) noexcept) only accepts
+// callables that are nothrow invocable and keeps operator() noexcept.
+
+#ifndef INPLACE_FUNCTION_FP
+#define INPLACE_FUNCTION_FP
+
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace fp {
+
+    namespace impl {
+
+        inline constexpr std::size_t default_inplace_capacity = 3 * sizeof(void*);
+
+        template < bool NoExcept, class Ret, class... Args >
+        struct InplaceVTable {
+            Ret (*invoke)(void*, Args&&...) noexcept(NoExcept);
+            void (*move)(void* target, void* source) noexcept;
+            void (*destroy)(void*) noexcept;
+        };
+
+        template < bool NoExcept, class Ret, class... Args >
+        [[noreturn]] Ret InvokeEmpty(void*, Args&&...) noexcept(NoExcept) {
+            if constexpr (NoExcept) {
+                std::terminate();
+            } else {
+                throw std::bad_function_call {};
+            }
+        }
+
+        template < bool NoExcept, class Ret, class... Args >
+        inline constexpr InplaceVTable< NoExcept, Ret, Args... > empty_vtable { &InvokeEmpty< NoExcept, Ret, Args... >, [](void*, void*) noexcept {},
+                                                                                [](void*) noexcept {} };
+
+        template < class Callable, bool NoExcept, class Ret, class... Args >
+        inline constexpr InplaceVTable< NoExcept, Ret, Args... > callable_vtable {
+            [](void* storage, Args&&... args) noexcept(NoExcept) -> Ret {
+                return std::invoke(*static_cast< Callable* >(storage), std::forward< Args >(args)...);
+            },
+            [](void* target, void* source) noexcept {
+                ::new (target) Callable(std::move(*static_cast< Callable* >(source)));
+                static_cast< Callable* >(source)->~Callable();
+            },
+            [](void* storage) noexcept { static_cast< Callable* >(storage)->~Callable(); }
+        };
+
+        template < bool NoExcept, std::size_t Capacity, std::size_t Alignment, class Ret, class... Args >
+        class InplaceFunctionImpl {
+            using VTable = InplaceVTable< NoExcept, Ret, Args... >;
+
+          public:
+            using result_type = Ret;
+
+            InplaceFunctionImpl() noexcept = default;
+            InplaceFunctionImpl(std::nullptr_t) noexcept {}
+
+            template < class Func, class Callable = std::decay_t< Func > >
+            requires(!std::is_base_of_v< InplaceFunctionImpl, Callable > &&
+                     (NoExcept ? std::is_nothrow_invocable_r_v< Ret, Callable&, Args... > : std::is_invocable_r_v< Ret, Callable&, Args... >))
+                InplaceFunctionImpl(Func&& func) {
+                static_assert(sizeof(Callable) <= Capacity, "Callable does not fit in the InplaceFunction buffer, increase Capacity");
+                static_assert(Alignment % alignof(Callable) == 0, "Callable is over-aligned for the InplaceFunction buffer");
+                static_assert(std::is_nothrow_move_constructible_v< Callable >, "InplaceFunction requires a nothrow move constructible callable");
+
+                ::new (static_cast< void* >(&storage)) Callable(std::forward< Func >(func));
+                vtable = &callable_vtable< Callable, NoExcept, Ret, Args... >;
+            }
+
+            InplaceFunctionImpl(InplaceFunctionImpl&& other) noexcept : vtable(other.vtable) {
+                vtable->move(&storage, &other.storage);
+                other.vtable = &empty_vtable< NoExcept, Ret, Args... >;
+            }
+            InplaceFunctionImpl& operator=(InplaceFunctionImpl&& other) noexcept {
+                if (this != &other) {
+                    vtable->destroy(&storage);
+                    vtable = other.vtable;
+                    vtable->move(&storage, &other.storage);
+                    other.vtable = &empty_vtable< NoExcept, Ret, Args... >;
+                }
+                return *this;
+            }
+            InplaceFunctionImpl& operator=(std::nullptr_t) noexcept {
+                vtable->destroy(&storage);
+                vtable = &empty_vtable< NoExcept, Ret, Args... >;
+                return *this;
+            }
+
+            InplaceFunctionImpl(const InplaceFunctionImpl&) = delete;
+            InplaceFunctionImpl& operator=(const InplaceFunctionImpl&) = delete;
+
+            ~InplaceFunctionImpl() { vtable->destroy(&storage); }
+
+            // Calling an empty function throws std::bad_function_call (terminates for noexcept signatures)
+            Ret operator()(Args... args) const noexcept(NoExcept) { return vtable->invoke(&storage, std::forward< Args >(args)...); }
+
+            [[nodiscard]] explicit operator bool() const noexcept { return vtable != &empty_vtable< NoExcept, Ret, Args... >; }
+
+            // Like std::function::target: the stored callable if it is a Callable, nullptr otherwise (no RTTI involved)
+            template < class Callable >
+            [[nodiscard]] const Callable* target() const noexcept {
+                if (vtable != &callable_vtable< Callable, NoExcept, Ret, Args... >) return nullptr;
+                return std::launder(reinterpret_cast< const Callable* >(&storage));
+            }
+
+          private:
+            const VTable* vtable = &empty_vtable< NoExcept, Ret, Args... >;
+            alignas(Alignment) mutable std::byte storage[Capacity];
+        };
+
+    } // namespace impl
+
+    template < class Signature, std::size_t Capacity = impl::default_inplace_capacity, std::size_t Alignment = alignof(std::max_align_t) >
+    class InplaceFunction;
+
+    /// <summary>
+    /// Move-only callable stored in a Capacity bytes inline buffer, never allocates
+    /// </summary>
+    template < class Ret, class... Args, std::size_t Capacity, std::size_t Alignment >
+    class InplaceFunction< Ret(Args...), Capacity, Alignment > final : public impl::InplaceFunctionImpl< false, Capacity, Alignment, Ret, Args... > {
+        using Base = impl::InplaceFunctionImpl< false, Capacity, Alignment, Ret, Args... >;
+
+      public:
+        using Base::Base;
+        using Base::operator();
+    };
+
+    /// <summary>
+    /// Move-only nothrow callable stored in a Capacity bytes inline buffer, never allocates
+    /// </summary>
+    template < class Ret, class... Args, std::size_t Capacity, std::size_t Alignment >
+    class InplaceFunction< Ret(Args...) noexcept, Capacity, Alignment > final : public impl::InplaceFunctionImpl< true, Capacity, Alignment, Ret, Args... > {
+        using Base = impl::InplaceFunctionImpl< true, Capacity, Alignment, Ret, Args... >;
+
+      public:
+        using Base::Base;
+        using Base::operator();
+    };
+
+} // namespace fp
+
+#endif // INPLACE_FUNCTION_FP
@@ -1,23 +1,34 @@
-
-
 #ifndef LINQ_CPP_CONTAINER
 #define LINQ_CPP_CONTAINER
 
 #include <CompositionHelper.hpp>
+#include <Execution.hpp>
 #include <FPUtility.hpp>
+#include <MappedFile.hpp>
+#include <Simd.hpp>
+#include <Tracing.hpp>
 #include <Traits.hpp>
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <concepts>
+#include <filesystem>
 #include <iterator>
 #include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
 #include <type_traits>
 #include <variant>
 #include <vector>
 
 namespace linq {
 
+    // Enumerator nodes are pooled, GetEnumerator() runs once per query
     template < class Type >
-    using UniqueRef = std::unique_ptr< Type, std::function< void(Type*) > >;
+    using UniqueRef = std::unique_ptr< Type, fp::PooledDeleter< Type > >;
 
+    // Type-erased interfaces, only used when an Enumerable is explicitly converted with AsIEnumerable()
     template < class Type >
     struct IEnumerator {
         /*using iterator_concept  = std::contiguous_iterator_tag;
@@ -32,6 +43,8 @@ namespace linq {
         using iterator        = typename std::vector< Type >::iterator;
         using const_iterator  = typename std::vector< Type >::const_iterator;
 
+        virtual ~IEnumerator() = default;
+
         virtual bool MoveNext() noexcept = 0;
 
         virtual value_type Current() const noexcept = 0;
@@ -40,130 +53,424 @@ namespace linq {
     template < class Type >
     class IEnumerable {
       public:
+        virtual ~IEnumerable() = default;
+
         virtual UniqueRef< IEnumerator< Type > > GetEnumerator() = 0;
     };
 
-    template < class TSource, class TResult, class Allocator, class Func = fp::CompositionFunction< void(void), void > >
-    struct Enumerator final : IEnumerator< TResult > {
-      private:
-        using Base = IEnumerator< TResult >;
+    namespace impl {
+        // Contiguous elements an Enumerable reads from. `owner` keeps adopted or mapped storage alive
+        // and is empty when the elements are borrowed from the caller
+        template < class Type >
+        struct Storage {
+            std::shared_ptr< const void > owner {};
+            const Type*                   data = nullptr;
+            std::size_t                   size = 0;
+        };
+
+        // Transformations are statically composed callables taking (element, index)
+        struct Identity {
+            template < class Type >
+            constexpr const Type& operator()(const Type& value, std::size_t) const noexcept {
+                return value;
+            }
+        };
+
+        template < class Previous, class Func, bool WithIndex >
+        struct Then {
+            [[no_unique_address]] Previous previous;
+            [[no_unique_address]] Func     func;
+
+            template < class Type >
+            constexpr decltype(auto) operator()(const Type& value, std::size_t index) const {
+                if constexpr (WithIndex) {
+                    return func(previous(value, index), index);
+                } else {
+                    return func(previous(value, index));
+                }
+            }
+        };
+
+        // Elements Sum/Average/Min/Max reduce, with the fp::simd kernels for every type but long double
+        template < class Type >
+        concept reducible = std::is_arithmetic_v< Type > && !std::same_as< Type, bool >;
+
+        // Elements of the storage reduced as one block, compensated sums are merged between blocks
+        inline constexpr std::size_t reduction_block_size = 4096;
+
+        // Sums of blocks: plain for integers, Neumaier-compensated for floating point so the error does not grow with the length
+        template < class Sum >
+        struct SumAccumulator {
+            Sum sum {};
+            Sum compensation {};
+
+            void Add(Sum value) noexcept {
+                if constexpr (std::is_floating_point_v< Sum >) {
+                    const auto total = sum + value;
+                    compensation += std::abs(sum) >= std::abs(value) ? (sum - total) + value : (value - total) + sum;
+                    sum = total;
+                } else {
+                    sum += value;
+                }
+            }
+            void Merge(const SumAccumulator& other) noexcept {
+                Add(other.sum);
+                compensation += other.compensation;
+            }
+            [[nodiscard]] Sum Result() const noexcept { return sum + compensation; }
+        };
 
-      public:
-        using typename Base::value_type;
-        using typename Base::difference_type;
-        using typename Base::pointer;
-        using typename Base::const_pointer;
-        using typename Base::reference;
-        using typename Base::const_reference;
-        using typename Base::size_type;
-        using typename Base::iterator;
-        using typename Base::const_iterator;
-
-        using function_type = Func;
-
-        Enumerator(std::initializer_list< TSource >&& data) :
-            mData(std::allocate_shared< std::vector< TSource, Allocator > >(Allocator {}, data)), mIndex(-1), mTransformation(nullptr) {};
-        Enumerator(std::initializer_list< TSource >&& data, size_type idx, Func&& transform) :
-            mData(std::allocate_shared< std::vector< TSource, Allocator > >(Allocator {}, data)), mIndex(idx), mTransformation(transform) {};
-
-        template < class OtherType, class OutputType, class OtherAlloc, class OtherFunc, class NewFunc >
-        Enumerator(const Enumerator< OtherType, OutputType, OtherAlloc, OtherFunc >& enumerator, NewFunc&& transform) :
-            mData(enumerator.mData), mIndex(enumerator.mIndex) {
-            if constexpr (std::is_same_v< typename decltype(enumerator.mTransformation)::return_type, void >) {
-                mTransformation = Func { transform };
+        template < class Type >
+        fp::sum_t< Type > BlockSum(std::span< const Type > block) noexcept {
+            if constexpr (fp::simd::lane_type< Type >) {
+                return fp::simd::WideSum(block);
             } else {
-                mTransformation = enumerator.mTransformation.Compose(transform);
+                fp::sum_t< Type > sum {};
+                for (const auto value : block) { sum += value; }
+                return sum;
             }
         }
 
-        bool MoveNext() noexcept override {
-            if (++mIndex >= mData->size()) { return false; }
-            return true;
+        template < class Type >
+        Type BlockMin(std::span< const Type > block) noexcept {
+            if constexpr (fp::simd::lane_type< Type >) {
+                return fp::simd::Min(block);
+            } else {
+                return *std::min_element(block.begin(), block.end());
+            }
         }
 
-        TResult Current() const noexcept override {
-            if constexpr (std::is_same_v< typename Func::return_type, void >) {
-                return mData->at(mIndex);
-            } else if constexpr (std::is_invocable_v< Func, TSource >) {
-                return mTransformation(mData->at(mIndex));
-            } else if constexpr (std::is_invocable_v< Func, TSource, size_type >) {
-                return mTransformation(mData->at(mIndex), mIndex);
+        template < class Type >
+        Type BlockMax(std::span< const Type > block) noexcept {
+            if constexpr (fp::simd::lane_type< Type >) {
+                return fp::simd::Max(block);
+            } else {
+                return *std::max_element(block.begin(), block.end());
             }
         }
+    } // namespace impl
+
+    /// <summary>
+    /// Statically dispatched enumerator, MoveNext/Current are plain inlinable calls
+    /// </summary>
+    template < class TSource, class TResult, class Allocator, class Transform = impl::Identity >
+    struct Enumerator final {
+        using value_type      = TResult;
+        using difference_type = typename std::vector< TSource, Allocator >::difference_type;
+        using size_type       = typename std::vector< TSource, Allocator >::size_type;
+
+        Enumerator(impl::Storage< TSource > data, Transform transform) : mData(std::move(data)), mIndex(-1), mTransformation(std::move(transform)) {}
 
-        void Reset() { mIndex = -1; }
+        bool MoveNext() noexcept { return ++mIndex < mData.size; }
 
-        template < class OtherType, class OutputType, class OtherAlloc, class OtherFunc >
-        friend class Enumerator;
+        decltype(auto) Current() const { return mTransformation(mData.data[mIndex], mIndex); }
+
+        void Reset() noexcept { mIndex = -1; }
 
       protected:
-        std::shared_ptr< std::vector< TSource, Allocator > > mData;
-        size_type                                            mIndex;
-        Func                                                 mTransformation;
+        impl::Storage< TSource >        mData;
+        size_type                       mIndex;
+        [[no_unique_address]] Transform mTransformation;
     };
 
-    template < class TSource, class Allocator = std::allocator< TSource >, class TResult = TSource, int Controller = 0 >
-    struct Enumerable final : IEnumerable< TResult > {
-        using MyEnumerator =
-            Enumerator< TSource, TResult, Allocator,
-                        std::conditional_t< Controller == 0, fp::CompositionFunction< void(void), void >,
-                                            std::conditional_t< Controller == 1, fp::CompositionFunction< TResult(TSource), void >,
-                                                                fp::CompositionFunction< TResult(TSource, typename std::vector< TSource >::size_type), void > > > >;
+    // Adapts a static enumerator to the IEnumerator interface
+    template < class StaticEnumerator >
+    struct ErasedEnumerator final : IEnumerator< typename StaticEnumerator::value_type > {
+        using typename IEnumerator< typename StaticEnumerator::value_type >::value_type;
+
+        ErasedEnumerator(StaticEnumerator enumerator) : mEnumerator(std::move(enumerator)) {}
+
+        bool MoveNext() noexcept override { return mEnumerator.MoveNext(); }
+
+        value_type Current() const noexcept override { return mEnumerator.Current(); }
+
+      private:
+        StaticEnumerator mEnumerator;
+    };
+
+    template < class StaticEnumerable >
+    class ErasedEnumerable final : public IEnumerable< typename StaticEnumerable::value_type > {
+        using value_type = typename StaticEnumerable::value_type;
+
+      public:
+        ErasedEnumerable(StaticEnumerable enumerable) : mEnumerable(std::move(enumerable)) {}
+
+        UniqueRef< IEnumerator< value_type > > GetEnumerator() override {
+            return fp::allocate_pooled< IEnumerator< value_type >, ErasedEnumerator< typename StaticEnumerable::MyEnumerator > >(mEnumerable.GetEnumerator());
+        }
+
+      private:
+        StaticEnumerable mEnumerable;
+    };
+
+    /// <summary>
+    /// Sequence over immutable contiguous storage. Select returns a new Enumerable whose Transform type
+    /// is the statically composed chain of every selector, so a whole query inlines into one loop.
+    /// Use AsIEnumerable() to cross a type-erased IEnumerable boundary.
+    /// Storage is either owned (initializer list, adopted vector, mapped file) or borrowed (span,
+    /// iterator pair); borrowed elements must outlive the Enumerable and everything selected from it.
+    /// Use parentheses with class template argument deduction, braces pick the initializer list.
+    /// </summary>
+    template < class TSource, class Allocator = std::allocator< TSource >, class Transform = impl::Identity >
+    struct Enumerable final {
+        using storage_type   = std::vector< TSource, Allocator >;
+        using size_type      = typename storage_type::size_type;
+        using allocator_type = Allocator;
+        using value_type     = std::remove_cvref_t< std::invoke_result_t< const Transform&, const TSource&, size_type > >;
+        using MyEnumerator   = Enumerator< TSource, value_type, Allocator, Transform >;
 
       public:
-        Enumerable(std::initializer_list< TSource > data) : mEnumerator { fp::allocate_unique< IEnumerator< TSource >, MyEnumerator >(Allocator {}, std::move(data)) } {}
-        Enumerable(UniqueRef< IEnumerator< TResult > > enumerator) : mEnumerator(std::move(enumerator)) {}
+        Enumerable(std::initializer_list< TSource > data) : Enumerable(storage_type(data)) {}
+        // Adopts the vector without copying its elements
+        explicit Enumerable(storage_type&& data) : mData(Adopt(std::move(data))), mTransformation {} {}
+        // Borrows the elements
+        explicit Enumerable(std::span< const TSource > data) : mData { {}, data.data(), data.size() }, mTransformation {} {}
+        // Borrows the elements
+        template < std::contiguous_iterator Iterator >
+        requires std::same_as< std::iter_value_t< Iterator >, TSource > Enumerable(Iterator first, Iterator last) :
+            mData { {}, std::to_address(first), static_cast< size_type >(last - first) }, mTransformation {} {}
+        // Reads the records in place from the mapping, which is kept alive by the Enumerable
+        explicit Enumerable(std::shared_ptr< const fp::MappedFile > file) requires std::is_trivially_copyable_v< TSource > : mTransformation {} {
+            const auto records = file->template As< TSource >();
+            mData              = impl::Storage< TSource > { std::move(file), records.data(), records.size() };
+        }
+        Enumerable(impl::Storage< TSource > data, Transform transform) : mData(std::move(data)), mTransformation(std::move(transform)) {}
 
-        UniqueRef< IEnumerator< TResult > > GetEnumerator() override {
-            return fp::allocate_unique< IEnumerator< TResult >, MyEnumerator >(Allocator {}, *reinterpret_cast< MyEnumerator* >(mEnumerator.get()));
+        // Memory maps a file of TSource records and queries it in place
+        [[nodiscard]] static Enumerable FromFile(const std::filesystem::path& path) requires std::is_trivially_copyable_v< TSource > {
+            return Enumerable { std::make_shared< const fp::MappedFile >(path) };
         }
 
-        template < class TAggregate, class Func, class Func2, class TResult = std::invoke_result_t< Func2, TAggregate > >
-        requires(std::is_invocable_r_v< TAggregate, Func, TAggregate, TSource >) TResult Aggregate(TAggregate seed, Func&& func, Func2&& resultSelector) {
+        [[nodiscard]] size_type size() const noexcept { return mData.size; }
+
+        [[nodiscard]] MyEnumerator GetEnumerator() const { return MyEnumerator { mData, mTransformation }; }
+
+        [[nodiscard]] ErasedEnumerable< Enumerable > AsIEnumerable() const { return ErasedEnumerable< Enumerable > { *this }; }
+
+        template < class TAggregate, class Func, class Func2, class TResult_ = std::invoke_result_t< Func2, TAggregate > >
+        requires(std::is_invocable_r_v< TAggregate, Func, TAggregate, value_type >) TResult_ Aggregate(TAggregate seed, Func&& func, Func2&& resultSelector) const {
+            fp::trace::OperatorScope scope { "Aggregate", size() };
+            scope.Output(1);
             TAggregate result = seed;
-            while (mEnumerator->MoveNext()) { result = func(result, mEnumerator->Current()); }
+            ForEachElement([&](auto&& element) { result = func(result, std::forward< decltype(element) >(element)); });
 
             return resultSelector(result);
         }
 
-        template < class TAccumulate, class Func, class TResult = std::invoke_result_t< Func, TAccumulate, TSource > >
-        requires(std::same_as< TAccumulate, TResult >) TResult Aggregate(TAccumulate seed, Func&& func) {
-            while (mEnumerator->MoveNext()) { seed = func(seed, mEnumerator->Current()); }
+        template < class TAccumulate, class Func, class TResult_ = std::invoke_result_t< Func, TAccumulate, value_type > >
+        requires(std::same_as< TAccumulate, TResult_ >) TResult_ Aggregate(TAccumulate seed, Func&& func) const {
+            fp::trace::OperatorScope scope { "Aggregate", size() };
+            scope.Output(1);
+            ForEachElement([&](auto&& element) { seed = func(seed, std::forward< decltype(element) >(element)); });
 
             return seed;
         }
 
         template < class Func >
-        requires(std::is_invocable_r_v< TSource, Func, TSource, TSource >&& fp::addable< TSource >) TSource Aggregate(Func&& func) {
-            TSource result {};
-            if (mEnumerator->MoveNext()) { result = mEnumerator->Current(); }
-
-            while (mEnumerator->MoveNext()) { result = func(result, mEnumerator->Current()); }
+        requires(std::is_invocable_r_v< value_type, Func, value_type, value_type >&& fp::addable< value_type >) value_type Aggregate(Func&& func) const {
+            fp::trace::OperatorScope scope { "Aggregate", size() };
+            scope.Output(std::min< size_type >(size(), 1));
+            value_type result {};
+            auto       first = true;
+            ForEachElement([&](auto&& element) {
+                if (first) {
+                    result = std::forward< decltype(element) >(element);
+                    first  = false;
+                } else {
+                    result = func(result, std::forward< decltype(element) >(element));
+                }
+            });
 
             return result;
         }
 
-        template < class Func, class TResult_ = std::invoke_result_t< Func, TSource > >
-        requires(std::is_invocable_v< Func, TSource >) auto Select(Func&& transform) {
-            return Enumerable< TSource, Allocator, TResult_, 1 > {
-                fp::allocate_unique< IEnumerator< TResult_ >, Enumerator< TSource, TResult_, Allocator, fp::CompositionFunction< TResult_(TSource), void > > >(
-                    Allocator {}, *reinterpret_cast< MyEnumerator* >(mEnumerator.get()), transform)
-            };
+        // Parallel fold: every chunk folds its elements into a copy of seed with func, then the chunk results are merged
+        // in order with combine. combine must be associative and seed an identity of it (0 for a sum, 1 for a product)
+        template < fp::execution::execution_policy Policy, class TAccumulate, class Func, class Combine >
+        requires(std::is_invocable_r_v< TAccumulate, Func&, TAccumulate, value_type >&& std::is_invocable_r_v< TAccumulate, Combine&, TAccumulate, TAccumulate >)
+            TAccumulate Aggregate(Policy&& policy, TAccumulate seed, Func&& func, Combine&& combine) const {
+            fp::trace::OperatorScope scope { "Aggregate", size() };
+            scope.Output(1);
+            return ReduceRanges(
+                policy, seed,
+                [&](size_type first, size_type last) {
+                    auto result = seed;
+                    ForEachElement(first, last, [&](auto&& element) { result = func(std::move(result), std::forward< decltype(element) >(element)); });
+                    return result;
+                },
+                combine);
         }
 
-        template < class Func, class TResult_ = std::invoke_result_t< Func, TSource, typename MyEnumerator::size_type > >
-        requires(std::is_invocable_v< Func, TSource, typename MyEnumerator::size_type >) auto Select(Func&& transform) {
-            return Enumerable< TSource, Allocator, TResult_, 2 > {
-                fp::allocate_unique< IEnumerator< TResult_ >,
-                                     Enumerator< TSource, TResult_, Allocator, fp::CompositionFunction< TResult_(TSource, typename MyEnumerator::size_type), void > > >(
-                    Allocator {}, *reinterpret_cast< MyEnumerator* >(mEnumerator.get()), transform)
-            };
+        // Arithmetic reductions, block by block with the fp::simd kernels. Sums accumulate in fp::sum_t (64 bits for
+        // integers, compensated between blocks for floating point) and integers average to double without truncation.
+        // With execution::par chunks are reduced in parallel and merged pairwise. Average/Min/Max of nothing throw std::out_of_range
+        [[nodiscard]] fp::sum_t< value_type > Sum() const requires impl::reducible< value_type > { return Sum(fp::execution::seq); }
+        template < fp::execution::execution_policy Policy >
+        [[nodiscard]] fp::sum_t< value_type > Sum(Policy&& policy) const requires impl::reducible< value_type > {
+            fp::trace::OperatorScope scope { "Sum", size() };
+            scope.Output(1);
+            return SumOf(policy).Result();
+        }
+
+        [[nodiscard]] fp::average_t< value_type > Average() const requires impl::reducible< value_type > { return Average(fp::execution::seq); }
+        template < fp::execution::execution_policy Policy >
+        [[nodiscard]] fp::average_t< value_type > Average(Policy&& policy) const requires impl::reducible< value_type > {
+            fp::trace::OperatorScope scope { "Average", size() };
+            if (size() == 0) throw std::out_of_range { "Average of an empty sequence" };
+            scope.Output(1);
+
+            using Quotient = std::conditional_t< std::is_integral_v< value_type >, double, fp::sum_t< value_type > >;
+            return static_cast< fp::average_t< value_type > >(static_cast< Quotient >(SumOf(policy).Result()) / static_cast< Quotient >(size()));
+        }
+
+        [[nodiscard]] value_type Min() const requires impl::reducible< value_type > { return Min(fp::execution::seq); }
+        template < fp::execution::execution_policy Policy >
+        [[nodiscard]] value_type Min(Policy&& policy) const requires impl::reducible< value_type > {
+            fp::trace::OperatorScope scope { "Min", size() };
+            if (size() == 0) throw std::out_of_range { "Min of an empty sequence" };
+            scope.Output(1);
+            return ReduceBlocks(policy, &impl::BlockMin< value_type >, [](value_type a, value_type b) { return std::min(a, b); });
+        }
+
+        [[nodiscard]] value_type Max() const requires impl::reducible< value_type > { return Max(fp::execution::seq); }
+        template < fp::execution::execution_policy Policy >
+        [[nodiscard]] value_type Max(Policy&& policy) const requires impl::reducible< value_type > {
+            fp::trace::OperatorScope scope { "Max", size() };
+            if (size() == 0) throw std::out_of_range { "Max of an empty sequence" };
+            scope.Output(1);
+            return ReduceBlocks(policy, &impl::BlockMax< value_type >, [](value_type a, value_type b) { return std::max(a, b); });
+        }
+
+        [[nodiscard]] size_type Count() const noexcept { return size(); }
+        template < class Predicate >
+        requires std::predicate< Predicate&, value_type >
+        [[nodiscard]] size_type Count(Predicate&& predicate) const {
+            return Count(fp::execution::seq, std::forward< Predicate >(predicate));
+        }
+        template < fp::execution::execution_policy Policy, class Predicate >
+        requires std::predicate< Predicate&, value_type >
+        [[nodiscard]] size_type Count(Policy&& policy, Predicate&& predicate) const {
+            fp::trace::OperatorScope scope { "Count", size() };
+            const auto               count = ReduceRanges(
+                policy, size_type { 0 },
+                [&](size_type first, size_type last) {
+                    size_type selected = 0;
+                    ForEachElement(first, last, [&](auto&& element) { selected += predicate(std::as_const(element)) ? 1 : 0; });
+                    return selected;
+                },
+                std::plus<> {});
+            scope.Output(count);
+            return count;
+        }
+
+        template < class Func >
+        requires(std::is_invocable_v< Func, value_type >) auto Select(Func&& transform) const {
+            using NextTransform = impl::Then< Transform, std::decay_t< Func >, false >;
+            return Enumerable< TSource, Allocator, NextTransform > { mData, NextTransform { mTransformation, std::forward< Func >(transform) } };
+        }
+
+        template < class Func >
+        requires(std::is_invocable_v< Func, value_type, size_type > && !std::is_invocable_v< Func, value_type >) auto Select(Func&& transform) const {
+            using NextTransform = impl::Then< Transform, std::decay_t< Func >, true >;
+            return Enumerable< TSource, Allocator, NextTransform > { mData, NextTransform { mTransformation, std::forward< Func >(transform) } };
         }
 
       private:
-        UniqueRef< IEnumerator< TResult > > mEnumerator;
+        // Direct indexed loop over the storage, no enumerator involved
+        template < class Consumer >
+        void ForEachElement(Consumer&& consumer) const {
+            ForEachElement(0, mData.size, std::forward< Consumer >(consumer));
+        }
+        template < class Consumer >
+        void ForEachElement(size_type first, size_type last, Consumer&& consumer) const {
+            const auto* data = mData.data;
+            for (size_type i = first; i < last; ++i) { consumer(mTransformation(data[i], i)); }
+        }
+
+        // Hands the elements of [first, last) to consumer as contiguous blocks: the storage itself when nothing is
+        // selected, the selected values computed into a stack buffer otherwise
+        template < class Consumer >
+        void ForEachBlock(size_type first, size_type last, Consumer&& consumer) const {
+            if constexpr (std::is_same_v< Transform, impl::Identity >) {
+                for (auto begin = first; begin < last; begin += impl::reduction_block_size) {
+                    consumer(std::span< const value_type > { mData.data + begin, std::min< size_type >(impl::reduction_block_size, last - begin) });
+                }
+            } else {
+                std::array< value_type, fp::batch_block_size > block;
+                for (auto begin = first; begin < last; begin += block.size()) {
+                    const auto end = std::min< size_type >(begin + block.size(), last);
+                    for (auto i = begin; i < end; ++i) { block[i - begin] = mTransformation(mData.data[i], i); }
+                    consumer(std::span< const value_type > { block.data(), end - begin });
+                }
+            }
+        }
+
+        // The whole sequence as one range with a sequenced policy, chunks reduced as parallel tasks otherwise.
+        // Partials are merged pairwise in their order, merge only needs to be associative
+        template < class Policy, class Partial, class ReduceRange, class Merge >
+        Partial ReduceRanges(const Policy& policy, [[maybe_unused]] const Partial& identity, ReduceRange&& reduceRange, Merge&& merge) const {
+            if constexpr (std::is_same_v< std::remove_cvref_t< Policy >, fp::execution::sequenced_policy >) {
+                return reduceRange(size_type { 0 }, size());
+            } else {
+                const auto             chunks = fp::impl::ChunkCount(size(), policy.grain_size);
+                std::vector< Partial > partials(chunks, identity);
+                fp::impl::ParallelChunks(size(), chunks, [&](std::size_t chunk, std::size_t first, std::size_t last) { partials[chunk] = reduceRange(first, last); });
+                for (std::size_t width = 1; width < chunks; width *= 2) {
+                    for (std::size_t i = 0; i + width < chunks; i += 2 * width) { partials[i] = merge(std::move(partials[i]), std::move(partials[i + width])); }
+                }
+                return std::move(partials.front());
+            }
+        }
+
+        // Reduces a non-empty sequence block by block with reduceBlock, block results are merged with merge
+        template < class Policy, class ReduceBlock, class Merge >
+        value_type ReduceBlocks(const Policy& policy, ReduceBlock reduceBlock, Merge merge) const {
+            const auto reduceRange = [&](size_type first, size_type last) {
+                std::optional< value_type > result {};
+                ForEachBlock(first, last, [&](std::span< const value_type > block) {
+                    const auto reduced = reduceBlock(block);
+                    result             = result ? merge(*result, reduced) : reduced;
+                });
+                return result;
+            };
+            const auto mergeOptional = [&](std::optional< value_type > a, std::optional< value_type > b) {
+                return a && b ? std::optional< value_type > { merge(*a, *b) } : (a ? a : b);
+            };
+            return *ReduceRanges(policy, std::optional< value_type > {}, reduceRange, mergeOptional);
+        }
+
+        template < class Policy >
+        auto SumOf(const Policy& policy) const {
+            using Accumulator = impl::SumAccumulator< fp::sum_t< value_type > >;
+            return ReduceRanges(
+                policy, Accumulator {},
+                [this](size_type first, size_type last) {
+                    Accumulator sum {};
+                    ForEachBlock(first, last, [&sum](std::span< const value_type > block) { sum.Add(impl::BlockSum(block)); });
+                    return sum;
+                },
+                [](Accumulator a, const Accumulator& b) {
+                    a.Merge(b);
+                    return a;
+                });
+        }
+
+        static impl::Storage< TSource > Adopt(storage_type&& data) {
+            auto owned = std::allocate_shared< storage_type >(Allocator {}, std::move(data));
+            return { owned, owned->data(), owned->size() };
+        }
+
+        impl::Storage< TSource >        mData;
+        [[no_unique_address]] Transform mTransformation;
     };
 
+    template < class Type, class Allocator >
+    Enumerable(std::vector< Type, Allocator >&&) -> Enumerable< Type, Allocator >;
+    template < class Type, std::size_t Extent >
+    Enumerable(std::span< Type, Extent >) -> Enumerable< std::remove_cv_t< Type > >;
+    template < std::contiguous_iterator Iterator >
+    Enumerable(Iterator, Iterator) -> Enumerable< std::iter_value_t< Iterator > >;
+
 } // namespace linq
 
-#endif // LINQ_CPP_CONTAINER
\ No newline at end of file
+#endif // LINQ_CPP_CONTAINER
@@ -10,29 +10,49 @@
 #include <algorithm>
 #include <concepts>
 #include <cstring>
+#include <functional>
 #include <memory>
 #include <numeric>
 #include <ranges>
+#include <span>
 #include <stdexcept>
 #include <type_traits>
 #include <vector>
+#include <Execution.hpp>
+#include <FlatHashMap.hpp>
+#include <LinqPipeline.hpp>
+#include <Lookup.hpp>
+#include <Simd.hpp>
 #include <Traits.hpp>
+#include <Tracing.hpp>
 
 namespace fp {
+    template < class Key, class Value, class Allocator >
+    struct Grouping;
+
     template < class Type, class Allocator = std::allocator< Type > >
     class LinqContainer {
       public:
-        using value_type     = typename std::vector< Type >::value_type;
-        using allocator_type = typename std::vector< Type >::allocator_type;
-        using size_type      = typename std::vector< Type >::size_type;
-        using iterator       = typename std::vector< Type >::iterator;
-        using const_iterator = typename std::vector< Type >::const_iterator;
-
-        LinqContainer(std::initializer_list< Type > elements_) : elements(elements_) {};
-        LinqContainer(std::vector< Type > elements_) : elements(elements_) {};
-        LinqContainer(size_type size) : elements(size) {};
-        LinqContainer()  = default;
-        ~LinqContainer() = default;
+        using value_type     = typename std::vector< Type, Allocator >::value_type;
+        using allocator_type = typename std::vector< Type, Allocator >::allocator_type;
+        using size_type      = typename std::vector< Type, Allocator >::size_type;
+        using iterator       = typename std::vector< Type, Allocator >::iterator;
+        using const_iterator = typename std::vector< Type, Allocator >::const_iterator;
+
+        // Every operator allocates its result (and any scratch memory) from a copy of this container's
+        // allocator, rebound to the element type it needs, so stateful allocators follow the whole chain
+        LinqContainer(std::initializer_list< Type > elements_, const Allocator& alloc = Allocator {}) : elements(elements_, alloc) {};
+        LinqContainer(std::vector< Type, Allocator > elements_) : elements(std::move(elements_)) {};
+        LinqContainer(size_type size, const Allocator& alloc = Allocator {}) : elements(size, alloc) {};
+        explicit LinqContainer(const Allocator& alloc) : elements(alloc) {};
+        LinqContainer()                     = default;
+        LinqContainer(const LinqContainer&) = default;
+        LinqContainer(LinqContainer&&)      = default;
+        LinqContainer& operator=(const LinqContainer&) = default;
+        LinqContainer& operator=(LinqContainer&&) = default;
+        ~LinqContainer()                              = default;
+
+        [[nodiscard]] inline allocator_type get_allocator() const noexcept { return elements.get_allocator(); }
 
         inline LinqContainer& emplace_back(Type&& element) {
             elements.emplace_back(std::move(element));
@@ -57,17 +77,40 @@ namespace fp {
         [[nodiscard]] inline constexpr auto empty() const noexcept { return elements.empty(); }
 
         [[nodiscard]] auto Take(size_type size_) && {
+            trace::OperatorScope scope { "Take", size() };
             if (size_ > size()) throw std::out_of_range { "Requested size is greater than the container size" };
             elements.resize(size_);
+            scope.Output(size_);
             return std::move(*this);
         }
         [[nodiscard]] auto Take(size_type size_) const& {
+            trace::OperatorScope scope { "Take", size() };
             if (size_ > size()) throw std::out_of_range { "Requested size is greater than the container size" };
-            LinqContainer new_elements {};
-            new_elements.resize(size());
-            while (size_ > 0) { new_elements[size_ - 1] = at(size_ - 1); }
+            std::vector< Type, Allocator > new_elements(elements.begin(), elements.begin() + size_, get_allocator());
+            scope.Output(size_, size_ * sizeof(Type));
 
-            return std::move(new_elements);
+            return LinqContainer { std::move(new_elements) };
+        }
+
+        // Equivalent to OrderBy(func).Take(size_) without sorting the whole container, yields at most size_ elements
+        template < std::predicate< Type, Type > Functor >
+        [[nodiscard]] auto TakeOrdered(size_type size_, Functor&& func) && -> LinqContainer {
+            trace::OperatorScope scope { "TakeOrdered", size() };
+            size_ = std::min(size_, size());
+            std::partial_sort(elements.begin(), elements.begin() + size_, elements.end(), func);
+            elements.resize(size_);
+            scope.Output(size_);
+
+            return std::move(elements);
+        }
+        template < std::predicate< Type, Type > Functor >
+        [[nodiscard]] auto TakeOrdered(size_type size_, Functor&& func) const& -> LinqContainer {
+            trace::OperatorScope           scope { "TakeOrdered", size() };
+            std::vector< Type, Allocator > new_elements(std::min(size_, size()), get_allocator());
+            std::partial_sort_copy(elements.begin(), elements.end(), new_elements.begin(), new_elements.end(), func);
+            scope.Output(new_elements.size(), new_elements.size() * sizeof(Type));
+
+            return LinqContainer { std::move(new_elements) };
         }
 
         [[nodiscard]] Type FirstOrDefault() const noexcept {
@@ -75,67 +118,485 @@ namespace fp {
             return elements.at(0);
         }
 
-        [[nodiscard]] Type Average() const requires addable< Type >&& dividable< Type > {
-            return std::accumulate(elements.begin(), elements.end(), value_type(0)) / elements.size();
+        // Integers are summed in 64 bits and averaged in double instead of truncating, see fp::average_t
+        [[nodiscard]] average_t< Type > Average() const requires addable< Type >&& dividable< Type > {
+            trace::OperatorScope scope { "Average", size() };
+            scope.Output(1);
+            return AverageOf(PartialSum(begin(), end()));
+        }
+        template < execution::execution_policy Policy >
+        [[nodiscard]] average_t< Type > Average(Policy&& policy) const requires addable< Type >&& dividable< Type > {
+            if constexpr (IsSequenced< Policy >) {
+                return Average();
+            } else {
+                using Sum = decltype(PartialSum(begin(), end()));
+
+                trace::OperatorScope              scope { "Average", size() };
+                const auto                        chunks = impl::ChunkCount(size(), policy.grain_size);
+                std::vector< Sum, Rebind< Sum > > partial_sums(chunks, Sum(0), Rebind< Sum >(get_allocator()));
+                scope.Output(1, chunks * sizeof(Sum));
+                impl::ParallelChunks(size(), chunks, [&](std::size_t chunk, std::size_t first, std::size_t last) {
+                    partial_sums[chunk] = PartialSum(begin() + first, begin() + last);
+                });
+
+                return AverageOf(std::accumulate(partial_sums.begin(), partial_sums.end(), Sum(0)));
+            }
         }
 
         template < std::predicate< Type, Type > Functor >
         [[nodiscard]] auto OrderBy(Functor&& func) && -> LinqContainer {
+            trace::OperatorScope scope { "OrderBy", size() };
+            scope.Output(size());
             std::sort(elements.begin(), elements.end(), func);
 
             return std::move(elements);
         }
         template < std::predicate< Type, Type > Functor >
         [[nodiscard]] auto OrderBy(Functor&& func) const& -> LinqContainer {
-            std::vector< Type, allocator_type > new_elements = elements;
+            trace::OperatorScope                scope { "OrderBy", size() };
+            std::vector< Type, allocator_type > new_elements(elements, get_allocator());
+            scope.Output(size(), size() * sizeof(Type));
             std::sort(new_elements.begin(), new_elements.end(), func);
 
             return LinqContainer { std::move(new_elements) };
         }
+        template < execution::execution_policy Policy, std::predicate< Type, Type > Functor >
+        [[nodiscard]] auto OrderBy(Policy&& policy, Functor&& func) && -> LinqContainer {
+            trace::OperatorScope scope { "OrderBy", size() };
+            scope.Output(size());
+            if constexpr (IsSequenced< Policy >) {
+                std::sort(elements.begin(), elements.end(), func);
+            } else {
+                ParallelSort(policy, func);
+            }
+
+            return std::move(elements);
+        }
+        template < execution::execution_policy Policy, std::predicate< Type, Type > Functor >
+        [[nodiscard]] auto OrderBy(Policy&& policy, Functor&& func) const& -> LinqContainer {
+            return LinqContainer { std::vector< Type, Allocator >(elements, get_allocator()) }.OrderBy(std::forward< Policy >(policy),
+                                                                                                      std::forward< Functor >(func));
+        }
 
         template < std::predicate< Type > Functor >
         [[nodiscard]] auto Where(Functor&& func) && -> LinqContainer {
-            LinqContainer new_elements {};
-            new_elements.resize(size());
-            auto count = Where_Internal(begin(), end(), new_elements.begin(), func);
+            trace::OperatorScope scope { "Where", size() };
+            LinqContainer        new_elements(size(), get_allocator());
+            auto                 count = Where_Internal(begin(), end(), new_elements.begin(), func);
             new_elements.resize(count);
+            scope.Output(count, size() * sizeof(Type));
             return std::move(new_elements);
         }
         template < std::predicate< Type > Functor >
         [[nodiscard]] auto Where(Functor&& func) const& -> LinqContainer {
-            LinqContainer new_elements {};
-            new_elements.resize(size());
-            auto count = Where_Internal(begin(), end(), new_elements.begin(), func);
+            trace::OperatorScope scope { "Where", size() };
+            LinqContainer        new_elements(size(), get_allocator());
+            auto                 count = Where_Internal(begin(), end(), new_elements.begin(), func);
             new_elements.resize(count);
+            scope.Output(count, size() * sizeof(Type));
             return std::move(new_elements);
         }
+        template < execution::execution_policy Policy, std::predicate< Type > Functor >
+        [[nodiscard]] auto Where(Policy&& policy, Functor&& func) const& -> LinqContainer {
+            if constexpr (IsSequenced< Policy >) {
+                return Where(std::forward< Functor >(func));
+            } else {
+                // Stable compaction: flag and count each chunk, prefix-sum the counts, then copy every chunk to its offset
+                trace::OperatorScope                                  scope { "Where", size() };
+                const auto                                         chunks = impl::ChunkCount(size(), policy.grain_size);
+                std::vector< unsigned char, Rebind< unsigned char > > keep(size(), Rebind< unsigned char >(get_allocator()));
+                std::vector< size_type, Rebind< size_type > >         offsets(chunks + 1, 0, Rebind< size_type >(get_allocator()));
+                impl::ParallelChunks(size(), chunks, [&](std::size_t chunk, std::size_t first, std::size_t last) {
+                    size_type count = 0;
+                    for (auto i = first; i < last; ++i) {
+                        keep[i] = func(elements[i]) ? 1 : 0;
+                        count += keep[i];
+                    }
+                    offsets[chunk + 1] = count;
+                });
+                auto new_elements = CopyKept(chunks, keep, offsets);
+                scope.Output(new_elements.size(), size() + offsets.size() * sizeof(size_type) + new_elements.size() * sizeof(Type));
+                return new_elements;
+            }
+        }
 
         template < class Functor, class Ret = std::invoke_result_t< Functor, Type >,
                    class Alloc = typename std::allocator_traits< allocator_type >::template rebind_alloc< Ret > >
         [[nodiscard]] auto Select(Functor&& func) && -> LinqContainer< Ret, Alloc > {
-            LinqContainer< Ret, Alloc > new_elements {};
-            new_elements.resize(size());
+            trace::OperatorScope        scope { "Select", size() };
+            LinqContainer< Ret, Alloc > new_elements(size(), Alloc(get_allocator()));
             Select_Internal(begin(), end(), new_elements.begin(), func);
+            scope.Output(size(), size() * sizeof(Ret));
 
             return std::move(new_elements);
         }
         template < class Functor, class Ret = std::invoke_result_t< Functor, Type >,
                    class Alloc = typename std::allocator_traits< allocator_type >::template rebind_alloc< Ret > >
         [[nodiscard]] auto Select(Functor&& func) const& -> LinqContainer< Ret, Alloc > {
-            LinqContainer< Ret, Alloc > new_elements {};
-            new_elements.resize(size());
+            trace::OperatorScope        scope { "Select", size() };
+            LinqContainer< Ret, Alloc > new_elements(size(), Alloc(get_allocator()));
             Select_Internal(begin(), end(), new_elements.begin(), func);
+            scope.Output(size(), size() * sizeof(Ret));
 
             return std::move(new_elements);
         }
+        template < execution::execution_policy Policy, class Functor, class Ret = std::invoke_result_t< Functor, Type >,
+                   class Alloc = typename std::allocator_traits< allocator_type >::template rebind_alloc< Ret > >
+        [[nodiscard]] auto Select(Policy&& policy, Functor&& func) const& -> LinqContainer< Ret, Alloc > {
+            if constexpr (IsSequenced< Policy >) {
+                return Select(std::forward< Functor >(func));
+            } else {
+                trace::OperatorScope        scope { "Select", size() };
+                LinqContainer< Ret, Alloc > new_elements(size(), Alloc(get_allocator()));
+                scope.Output(size(), size() * sizeof(Ret));
+                impl::ParallelChunks(size(), impl::ChunkCount(size(), policy.grain_size), [&](std::size_t, std::size_t first, std::size_t last) {
+                    Select_Internal(begin() + first, begin() + last, new_elements.begin() + first, func);
+                });
+
+                return new_elements;
+            }
+        }
+
+        // Lazy mode, see LinqPipeline.hpp. Borrows the elements, the container must outlive the pipeline
+        [[nodiscard]] auto AsLazy() const& {
+            using Source = impl::lazy::BorrowedSource< typename std::vector< Type, Allocator >::const_iterator >;
+            return LinqPipeline< Type, Allocator, Source > { Source { elements.cbegin(), elements.cend() }, {}, get_allocator() };
+        }
+        // Lazy mode, see LinqPipeline.hpp. Takes ownership of the elements
+        [[nodiscard]] auto AsLazy() && {
+            using Source = impl::lazy::OwnedSource< std::vector< Type, Allocator > >;
+            auto alloc = get_allocator();
+            return LinqPipeline< Type, Allocator, Source > { Source { std::move(elements) }, {}, alloc };
+        }
 
         template < class TAction >
         auto ForEach(TAction&& func)
             -> void requires(std::same_as< std::invoke_result_t< TAction, Type >, void >) { // Modifying the underlying behaviour causes undefined behaviour
             std::for_each(begin(), end(), func);
         }
+        template < execution::execution_policy Policy, class TAction >
+        auto ForEach(Policy&& policy, TAction&& func) -> void requires(std::same_as< std::invoke_result_t< TAction, Type >, void >) {
+            if constexpr (IsSequenced< Policy >) {
+                ForEach(std::forward< TAction >(func));
+            } else {
+                impl::ParallelChunks(size(), impl::ChunkCount(size(), policy.grain_size),
+                                     [&](std::size_t, std::size_t first, std::size_t last) { std::for_each(begin() + first, begin() + last, func); });
+            }
+        }
+
+        // Indexes the elements by keySelector(element), keys must be unique (std::invalid_argument otherwise).
+        // Selectors may be member pointers. Enum keys with an fp::enum_size give a flat EnumDictionary, other keys a FlatHashMap
+        template < class KeySelector, class ValueSelector = std::identity, class Key = std::remove_cvref_t< std::invoke_result_t< KeySelector&, const Type& > >,
+                   class Value = std::remove_cvref_t< std::invoke_result_t< ValueSelector&, const Type& > > >
+        [[nodiscard]] auto ToDictionary(KeySelector&& keySelector, ValueSelector&& valueSelector = {}) const {
+            if constexpr (indexable_enum< Key >) {
+                EnumDictionary< Key, Value > dictionary {};
+                for (const auto& element : elements) {
+                    if (!dictionary.TryAdd(std::invoke(keySelector, element), std::invoke(valueSelector, element)))
+                        throw std::invalid_argument { "ToDictionary found a duplicate key" };
+                }
+                return dictionary;
+            } else {
+                using Pair = std::pair< Key, Value >;
+                FlatHashMap< Key, Value, std::hash< Key >, std::equal_to< Key >, Rebind< Pair > > dictionary(size(), std::hash< Key > {}, std::equal_to< Key > {},
+                                                                                                           Rebind< Pair >(get_allocator()));
+                for (const auto& element : elements) {
+                    if (!dictionary.TryAdd(std::invoke(keySelector, element), std::invoke(valueSelector, element)))
+                        throw std::invalid_argument { "ToDictionary found a duplicate key" };
+                }
+                return dictionary;
+            }
+        }
+
+        // Groups the elements by keySelector(element), each key maps to its values in source order.
+        // Enum keys with an fp::enum_size give a flat EnumLookup, other keys a FlatLookup
+        template < class KeySelector, class ValueSelector = std::identity, class Key = std::remove_cvref_t< std::invoke_result_t< KeySelector&, const Type& > >,
+                   class Value = std::remove_cvref_t< std::invoke_result_t< ValueSelector&, const Type& > > >
+        [[nodiscard]] auto ToLookup(KeySelector&& keySelector, ValueSelector&& valueSelector = {}) const {
+            return ToLookup(execution::seq, std::forward< KeySelector >(keySelector), std::forward< ValueSelector >(valueSelector));
+        }
+        template < execution::execution_policy Policy, class KeySelector, class ValueSelector = std::identity,
+                   class Key   = std::remove_cvref_t< std::invoke_result_t< KeySelector&, const Type& > >,
+                   class Value = std::remove_cvref_t< std::invoke_result_t< ValueSelector&, const Type& > > >
+        [[nodiscard]] auto ToLookup(Policy&& policy, KeySelector&& keySelector, ValueSelector&& valueSelector = {}) const {
+            if constexpr (indexable_enum< Key >) {
+                return EnumLookup< Key, Value, Rebind< Value > >(elements, keySelector, valueSelector, Rebind< Value >(get_allocator()));
+            } else {
+                return FlatLookup< Key, Value, std::hash< Key >, std::equal_to< Key >, Rebind< Value > >(policy, elements, keySelector, valueSelector,
+                                                                                                       Rebind< Value >(get_allocator()));
+            }
+        }
+
+        // Hash-based operators on the tables of FlatHashMap.hpp, keys need std::hash and operator==. Groups and distinct
+        // elements come in order of first appearance, the elements of a group in source order. With execution::par the keys
+        // are hashed in parallel and the elements partitioned by hash, every partition builds its own table
+
+        // Groups the elements (or valueSelector(element)) by keySelector(element), one Grouping per key
+        template < class KeySelector, class ValueSelector = std::identity, class Key = std::remove_cvref_t< std::invoke_result_t< KeySelector&, const Type& > >,
+                   class Value = std::remove_cvref_t< std::invoke_result_t< ValueSelector&, const Type& > > >
+        [[nodiscard]] auto GroupBy(KeySelector&& keySelector, ValueSelector&& valueSelector = {}) const {
+            return GroupBy(execution::seq, std::forward< KeySelector >(keySelector), std::forward< ValueSelector >(valueSelector));
+        }
+        template < execution::execution_policy Policy, class KeySelector, class ValueSelector = std::identity,
+                   class Key   = std::remove_cvref_t< std::invoke_result_t< KeySelector&, const Type& > >,
+                   class Value = std::remove_cvref_t< std::invoke_result_t< ValueSelector&, const Type& > > >
+        [[nodiscard]] auto GroupBy(Policy&& policy, KeySelector&& keySelector, ValueSelector&& valueSelector = {}) const {
+            using Group   = Grouping< Key, Value, Rebind< Value > >;
+            using Members = std::vector< Value, Rebind< Value > >;
+
+            trace::OperatorScope scope { "GroupBy", size() };
+            std::size_t          chunks = 1;
+            if constexpr (!IsSequenced< Policy >) chunks = impl::ChunkCount(size(), policy.grain_size);
+
+            // One pass, every value goes straight into its group
+            if (chunks == 1) {
+                const std::hash< Key >                hash {};
+                const std::equal_to< Key >            equal {};
+                impl::FlatIndex< Allocator >          index(get_allocator());
+                std::vector< Group, Rebind< Group > > groups { Rebind< Group >(get_allocator()) };
+                for (const auto& element : elements) {
+                    const Key& key            = std::invoke(keySelector, element);
+                    const auto [group, added] = index.FindOrInsert(impl::MixedHash(hash, key), groups.size(),
+                                                                   [&](size_type candidate) { return equal(groups[candidate].key, key); });
+                    if (added) groups.push_back(Group { key, LinqContainer< Value, Rebind< Value > > { Rebind< Value >(get_allocator()) } });
+                    groups[group].elements.emplace_back(std::invoke(valueSelector, element));
+                }
+                scope.Output(groups.size(), groups.capacity() * sizeof(Group) + size() * sizeof(Value));
+                return LinqContainer< Group, Rebind< Group > > { std::move(groups) };
+            }
+
+            // The partitioned lookup holds pointers, so every value is constructed once, straight into its group
+            const auto lookup = FlatLookup< Key, const Type*, std::hash< Key >, std::equal_to< Key >, Rebind< const Type* > >(
+                policy, elements, keySelector, [](const Type& element) { return &element; }, Rebind< const Type* >(get_allocator()));
+
+            std::vector< Group, Rebind< Group > > groups { Rebind< Group >(get_allocator()) };
+            groups.reserve(lookup.GroupCount());
+            for (size_type group = 0; group < lookup.GroupCount(); ++group) {
+                Members members { Rebind< Value >(get_allocator()) };
+                members.reserve(lookup.Group(group).size());
+                groups.push_back(Group { lookup.Keys()[group], LinqContainer< Value, Rebind< Value > > { std::move(members) } });
+            }
+            scope.Output(groups.size(), lookup.GroupCount() * sizeof(Group) + size() * (sizeof(Value) + sizeof(const Type*)));
+
+            // Capacities are reserved, filling the groups in parallel does not allocate
+            const auto fill = [&](std::size_t, std::size_t first, std::size_t last) {
+                for (auto group = first; group < last; ++group) {
+                    for (const auto* element : lookup.Group(group)) { groups[group].elements.emplace_back(std::invoke(valueSelector, *element)); }
+                }
+            };
+            impl::ParallelChunks(groups.size(), std::clamp< std::size_t >(groups.size(), 1, chunks), fill);
+            return LinqContainer< Group, Rebind< Group > > { std::move(groups) };
+        }
+
+        // Inner equi-join: resultSelector(element, match) for every element of inner whose key equals the element's key,
+        // in the order of this container, then of inner. inner is hashed once, the elements of this container probe it
+        template < class Inner, class InnerAllocator, class OuterKeySelector, class InnerKeySelector, class ResultSelector,
+                   class Key = std::remove_cvref_t< std::invoke_result_t< OuterKeySelector&, const Type& > > >
+        [[nodiscard]] auto Join(const LinqContainer< Inner, InnerAllocator >& inner, OuterKeySelector&& outerKeySelector, InnerKeySelector&& innerKeySelector,
+                                ResultSelector&& resultSelector) const {
+            return Join(execution::seq, inner, std::forward< OuterKeySelector >(outerKeySelector), std::forward< InnerKeySelector >(innerKeySelector),
+                        std::forward< ResultSelector >(resultSelector));
+        }
+        template < execution::execution_policy Policy, class Inner, class InnerAllocator, class OuterKeySelector, class InnerKeySelector, class ResultSelector,
+                   class Key = std::remove_cvref_t< std::invoke_result_t< OuterKeySelector&, const Type& > > >
+        [[nodiscard]] auto Join(Policy&& policy, const LinqContainer< Inner, InnerAllocator >& inner, OuterKeySelector&& outerKeySelector,
+                                InnerKeySelector&& innerKeySelector, ResultSelector&& resultSelector) const {
+            using Result = std::remove_cvref_t< std::invoke_result_t< ResultSelector&, const Type&, const Inner& > >;
+
+            trace::OperatorScope scope { "Join", size() + inner.size() };
+            const auto           lookup = FlatLookup< Key, const Inner*, std::hash< Key >, std::equal_to< Key >, Rebind< const Inner* > >(
+                policy, inner, innerKeySelector, [](const Inner& element) { return &element; }, Rebind< const Inner* >(get_allocator()));
+
+            if constexpr (IsSequenced< Policy > || !std::is_default_constructible_v< Result >) {
+                std::vector< Result, Rebind< Result > > results { Rebind< Result >(get_allocator()) };
+                for (const auto& element : elements) {
+                    for (const auto* match : lookup[std::invoke(outerKeySelector, element)]) { results.emplace_back(std::invoke(resultSelector, element, *match)); }
+                }
+                scope.Output(results.size(), inner.size() * sizeof(const Inner*) + results.capacity() * sizeof(Result));
+                return LinqContainer< Result, Rebind< Result > > { std::move(results) };
+            } else {
+                // Every chunk probes once and counts its matches, then writes its results from its offset
+                const auto                                    chunks = impl::ChunkCount(size(), policy.grain_size);
+                std::vector< size_type, Rebind< size_type > > groupOf(size(), 0, Rebind< size_type >(get_allocator()));
+                std::vector< size_type, Rebind< size_type > > offsets(chunks + 1, 0, Rebind< size_type >(get_allocator()));
+                impl::ParallelChunks(size(), chunks, [&](std::size_t chunk, std::size_t first, std::size_t last) {
+                    size_type matches = 0;
+                    for (auto i = first; i < last; ++i) {
+                        groupOf[i] = lookup.IndexOf(std::invoke(outerKeySelector, elements[i]));
+                        if (groupOf[i] != lookup.npos) matches += lookup.Group(groupOf[i]).size();
+                    }
+                    offsets[chunk + 1] = matches;
+                });
+                std::inclusive_scan(offsets.begin(), offsets.end(), offsets.begin());
+
+                LinqContainer< Result, Rebind< Result > > results(offsets.back(), Rebind< Result >(get_allocator()));
+                scope.Output(offsets.back(), inner.size() * sizeof(const Inner*) + size() * sizeof(size_type) + offsets.back() * sizeof(Result));
+                impl::ParallelChunks(size(), chunks, [&](std::size_t chunk, std::size_t first, std::size_t last) {
+                    auto target_element = results.begin() + offsets[chunk];
+                    for (auto i = first; i < last; ++i) {
+                        if (groupOf[i] == lookup.npos) continue;
+                        for (const auto* match : lookup.Group(groupOf[i])) { *target_element++ = std::invoke(resultSelector, elements[i], *match); }
+                    }
+                });
+                return results;
+            }
+        }
+
+        // Left outer group join: resultSelector(element, matches) once per element of this container, matches being the
+        // std::span of the elements of inner whose key equals the element's key, in their order (empty when there is none)
+        template < class Inner, class InnerAllocator, class OuterKeySelector, class InnerKeySelector, class ResultSelector,
+                   class Key = std::remove_cvref_t< std::invoke_result_t< OuterKeySelector&, const Type& > > >
+        [[nodiscard]] auto GroupJoin(const LinqContainer< Inner, InnerAllocator >& inner, OuterKeySelector&& outerKeySelector, InnerKeySelector&& innerKeySelector,
+                                     ResultSelector&& resultSelector) const {
+            return GroupJoin(execution::seq, inner, std::forward< OuterKeySelector >(outerKeySelector), std::forward< InnerKeySelector >(innerKeySelector),
+                             std::forward< ResultSelector >(resultSelector));
+        }
+        template < execution::execution_policy Policy, class Inner, class InnerAllocator, class OuterKeySelector, class InnerKeySelector, class ResultSelector,
+                   class Key = std::remove_cvref_t< std::invoke_result_t< OuterKeySelector&, const Type& > > >
+        [[nodiscard]] auto GroupJoin(Policy&& policy, const LinqContainer< Inner, InnerAllocator >& inner, OuterKeySelector&& outerKeySelector,
+                                     InnerKeySelector&& innerKeySelector, ResultSelector&& resultSelector) const {
+            using Result = std::remove_cvref_t< std::invoke_result_t< ResultSelector&, const Type&, std::span< const Inner > > >;
+
+            // The lookup copies inner so that every key's matches are contiguous
+            trace::OperatorScope scope { "GroupJoin", size() + inner.size() };
+            const auto           lookup = FlatLookup< Key, Inner, std::hash< Key >, std::equal_to< Key >, Rebind< Inner > >(policy, inner, innerKeySelector, std::identity {},
+                                                                                                                   Rebind< Inner >(get_allocator()));
+            const auto           join   = [&](const Type& element) { return std::invoke(resultSelector, element, lookup[std::invoke(outerKeySelector, element)]); };
+
+            LinqContainer< Result, Rebind< Result > > results(size(), Rebind< Result >(get_allocator()));
+            scope.Output(size(), inner.size() * sizeof(Inner) + size() * sizeof(Result));
+            if constexpr (IsSequenced< Policy >) {
+                Select_Internal(begin(), end(), results.begin(), join);
+            } else {
+                impl::ParallelChunks(size(), impl::ChunkCount(size(), policy.grain_size), [&](std::size_t, std::size_t first, std::size_t last) {
+                    Select_Internal(begin() + first, begin() + last, results.begin() + first, join);
+                });
+            }
+            return results;
+        }
+
+        // Elements equal to none before them, in source order
+        [[nodiscard]] auto Distinct() const -> LinqContainer { return DistinctBy(std::identity {}); }
+        template < execution::execution_policy Policy >
+        [[nodiscard]] auto Distinct(Policy&& policy) const -> LinqContainer {
+            return DistinctBy(std::forward< Policy >(policy), std::identity {});
+        }
+
+        // Elements whose keySelector(element) differs from the key of every element before them, in source order
+        template < class KeySelector, class Key = std::remove_cvref_t< std::invoke_result_t< KeySelector&, const Type& > > >
+        [[nodiscard]] auto DistinctBy(KeySelector&& keySelector) const -> LinqContainer {
+            return DistinctBy(execution::seq, std::forward< KeySelector >(keySelector));
+        }
+        template < execution::execution_policy Policy, class KeySelector, class Key = std::remove_cvref_t< std::invoke_result_t< KeySelector&, const Type& > > >
+        [[nodiscard]] auto DistinctBy(Policy&& policy, KeySelector&& keySelector) const -> LinqContainer {
+            const std::hash< Key >     hash {};
+            const std::equal_to< Key > equal {};
+            const auto                 keyAt  = [&](size_type i) -> decltype(auto) { return std::invoke(keySelector, elements[i]); };
+            const auto                 hashAt = [&](size_type i) { return impl::MixedHash(hash, static_cast< const Key& >(keyAt(i))); };
+
+            trace::OperatorScope scope { "Distinct", size() };
+            std::size_t          chunks = 1;
+            if constexpr (!IsSequenced< Policy >) chunks = impl::ChunkCount(size(), policy.grain_size);
+
+            if (chunks == 1) {
+                impl::FlatIndex< Allocator >   seen(get_allocator());
+                std::vector< Type, Allocator > new_elements(get_allocator());
+                for (size_type i = 0; i < size(); ++i) {
+                    const Key& key = keyAt(i);
+                    if (seen.FindOrInsert(hashAt(i), i, [&](size_type candidate) { return equal(keyAt(candidate), key); }).second) new_elements.push_back(elements[i]);
+                }
+                scope.Output(new_elements.size(), new_elements.capacity() * sizeof(Type));
+                return LinqContainer { std::move(new_elements) };
+            }
+
+            // Every partition keeps the first element of each of its keys, then the kept elements are compacted in order
+            const auto                                            partitions = impl::PartitionByHash(size(), chunks, hashAt, get_allocator());
+            auto                                                  tables     = partitions.Tables();
+            std::vector< unsigned char, Rebind< unsigned char > > keep(size(), 0, Rebind< unsigned char >(get_allocator()));
+            impl::ParallelFor(partitions.Count(), [&](std::size_t partition) {
+                for (auto slot = partitions.offsets[partition]; slot < partitions.offsets[partition + 1]; ++slot) {
+                    const auto i   = partitions.order[slot];
+                    const Key& key = keyAt(i);
+                    keep[i]        = tables[partition].FindOrInsert(partitions.hashes[i], i, [&](size_type candidate) { return equal(keyAt(candidate), key); }).second;
+                }
+            });
+
+            std::vector< size_type, Rebind< size_type > > offsets(chunks + 1, 0, Rebind< size_type >(get_allocator()));
+            impl::ParallelChunks(size(), chunks, [&](std::size_t chunk, std::size_t first, std::size_t last) {
+                offsets[chunk + 1] = static_cast< size_type >(std::count(keep.begin() + first, keep.begin() + last, 1));
+            });
+            auto new_elements = CopyKept(chunks, keep, offsets);
+            scope.Output(new_elements.size(), size() * (sizeof(std::uint64_t) + sizeof(size_type) + 1) + new_elements.size() * sizeof(Type));
+            return new_elements;
+        }
 
       private:
+        template < class Other >
+        using Rebind = typename std::allocator_traits< Allocator >::template rebind_alloc< Other >;
+
+        template < class Policy >
+        static constexpr bool IsSequenced = std::is_same_v< std::remove_cvref_t< Policy >, execution::sequenced_policy >;
+
+        // Sorts every chunk in parallel, then merges neighbouring runs pairwise until one run is left
+        template < class Functor >
+        void ParallelSort(const execution::parallel_policy& policy, Functor& func) {
+            const auto chunks = impl::ChunkCount(size(), policy.grain_size);
+            impl::ParallelChunks(size(), chunks, [&](std::size_t, std::size_t first, std::size_t last) {
+                std::sort(elements.begin() + first, elements.begin() + last, func);
+            });
+
+            for (std::size_t width = 1; width < chunks; width *= 2) {
+                impl::ParallelFor((chunks + 2 * width - 1) / (2 * width), [&](std::size_t merge) {
+                    const auto firstChunk  = merge * 2 * width;
+                    const auto middleChunk = firstChunk + width;
+                    if (middleChunk >= chunks) return;
+                    const auto lastChunk = std::min(middleChunk + width, chunks) - 1;
+
+                    std::inplace_merge(elements.begin() + impl::ChunkRange(size(), chunks, firstChunk).first,
+                                       elements.begin() + impl::ChunkRange(size(), chunks, middleChunk).first,
+                                       elements.begin() + impl::ChunkRange(size(), chunks, lastChunk).second, func);
+                });
+            }
+        }
+
+        // Arithmetic elements are summed by the SIMD kernel into fp::sum_t, other types in their own type
+        [[nodiscard]] auto PartialSum(const_iterator first, const_iterator last) const {
+            if constexpr (simd::lane_type< Type >) {
+                return simd::WideSum(std::span< const Type > { first, last });
+            } else {
+                return std::accumulate(first, last, value_type(0));
+            }
+        }
+
+        template < class Sum >
+        [[nodiscard]] average_t< Type > AverageOf(const Sum& sum) const {
+            if constexpr (std::is_arithmetic_v< Sum >) {
+                using Quotient = std::conditional_t< std::is_integral_v< Sum >, double, Sum >;
+                return static_cast< average_t< Type > >(static_cast< Quotient >(sum) / static_cast< Quotient >(size()));
+            } else {
+                return sum / elements.size();
+            }
+        }
+
+        // Stable compaction of the elements flagged in keep: offsets[chunk + 1] holds how many the chunk keeps, after the
+        // prefix sum every chunk copies them from its offset
+        [[nodiscard]] LinqContainer CopyKept(std::size_t chunks, const std::vector< unsigned char, Rebind< unsigned char > >& keep,
+                                             std::vector< size_type, Rebind< size_type > >& offsets) const {
+            std::inclusive_scan(offsets.begin(), offsets.end(), offsets.begin());
+
+            LinqContainer new_elements(offsets.back(), get_allocator());
+            impl::ParallelChunks(size(), chunks, [&](std::size_t chunk, std::size_t first, std::size_t last) {
+                auto target_element = new_elements.begin() + offsets[chunk];
+                for (auto i = first; i < last; ++i) {
+                    if (keep[i]) {
+                        *target_element = elements[i];
+                        target_element++;
+                    }
+                }
+            });
+            return new_elements;
+        }
+
         template < class Init, class OutIt, class TInit, class Functor >
         [[nodiscard]] auto Where_Internal(const Init start, const OutIt last, TInit target, Functor&& func) const {
             auto       first_element  = start;
@@ -163,6 +624,15 @@ namespace fp {
         std::vector< Type, Allocator > elements;
     };
 
+    /// <summary>
+    /// One group of GroupBy: its key and its elements in source order
+    /// </summary>
+    template < class Key, class Value, class Allocator = std::allocator< Value > >
+    struct Grouping {
+        Key                               key;
+        LinqContainer< Value, Allocator > elements;
+    };
+
     template < class Type, class Allocator = std::allocator< Type > >
     class LinqContainerView : public std::ranges::view_interface< LinqContainerView< Type, Allocator > > {
         LinqContainerView()  = default;
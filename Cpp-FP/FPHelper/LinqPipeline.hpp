@@ -0,0 +1,520 @@
+// This header represents the lazy (fused) pipeline mode of LinqContainer
+// Chained operators only record themselves, a terminal operator then pushes every
+// element once through the whole chain without any intermediate container
+
+#ifndef LINQ_PIPELINE
+#define LINQ_PIPELINE
+
+#include <Traits.hpp>
+#include <Tracing.hpp>
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace fp {
+
+    template < class Type, class Allocator, class Source, class... Operators >
+    class LinqPipeline;
+
+    namespace impl::lazy {
+
+        // Sources push their elements into a sink until the sink refuses more (returns false)
+        template < class Iterator >
+        struct BorrowedSource {
+            using value_type = std::iter_value_t< Iterator >;
+
+            Iterator first;
+            Iterator last;
+
+            template < class Sink >
+            void Push(Sink& sink) const {
+                for (auto it = first; it != last; ++it) {
+                    if (!sink.Push(*it)) return;
+                }
+            }
+        };
+
+        template < class Container >
+        struct OwnedSource {
+            using value_type = typename Container::value_type;
+
+            Container elements;
+
+            template < class Sink >
+            void Push(Sink& sink) {
+                for (auto& element : elements) {
+                    if (!sink.Push(std::move(element))) return;
+                }
+            }
+        };
+
+        // Sinks, one per operator. Each one forwards to the sink of the next operator
+        template < class Predicate, class Downstream >
+        struct WhereSink {
+            Predicate& predicate;
+            Downstream downstream;
+
+            template < class Value >
+            bool Push(Value&& value) {
+                if (!predicate(std::as_const(value))) return true;
+                return downstream.Push(std::forward< Value >(value));
+            }
+            void Finish() { downstream.Finish(); }
+        };
+
+        template < class Functor, class Downstream >
+        struct SelectSink {
+            Functor&   functor;
+            Downstream downstream;
+
+            template < class Value >
+            bool Push(Value&& value) {
+                return downstream.Push(functor(std::forward< Value >(value)));
+            }
+            void Finish() { downstream.Finish(); }
+        };
+
+        template < class Type, class Allocator, class Comparator, class Downstream >
+        struct OrderBySink {
+            Comparator&                     comparator;
+            Downstream                      downstream;
+            std::vector< Type, Allocator > buffer;
+
+            template < class Value >
+            bool Push(Value&& value) {
+                buffer.emplace_back(std::forward< Value >(value));
+                return true;
+            }
+            void Finish() {
+                std::sort(buffer.begin(), buffer.end(), comparator);
+                for (auto& element : buffer) {
+                    if (!downstream.Push(std::move(element))) break;
+                }
+                downstream.Finish();
+            }
+            [[nodiscard]] std::size_t AllocatedBytes() const noexcept { return buffer.capacity() * sizeof(Type); }
+        };
+
+        // Keeps the best `count` elements in a bounded max-heap (with respect to comparator)
+        // so OrderBy(...).Take(n) costs O(N log n) and n elements of memory instead of a full sort
+        template < class Type, class Allocator, class Comparator, class Downstream >
+        struct TopNSink {
+            Comparator&                    comparator;
+            std::size_t                    count;
+            Downstream                     downstream;
+            std::vector< Type, Allocator > heap;
+
+            template < class Value >
+            bool Push(Value&& value) {
+                if (count == 0) return false;
+                if (heap.size() < count) {
+                    heap.emplace_back(std::forward< Value >(value));
+                    std::push_heap(heap.begin(), heap.end(), comparator);
+                } else if (comparator(std::as_const(value), heap.front())) {
+                    std::pop_heap(heap.begin(), heap.end(), comparator);
+                    heap.back() = std::forward< Value >(value);
+                    std::push_heap(heap.begin(), heap.end(), comparator);
+                }
+                return true;
+            }
+            void Finish() {
+                std::sort_heap(heap.begin(), heap.end(), comparator);
+                for (auto& element : heap) {
+                    if (!downstream.Push(std::move(element))) break;
+                }
+                downstream.Finish();
+            }
+            [[nodiscard]] std::size_t AllocatedBytes() const noexcept { return heap.capacity() * sizeof(Type); }
+        };
+
+        template < class Downstream >
+        struct TakeSink {
+            std::size_t remaining;
+            Downstream  downstream;
+
+            template < class Value >
+            bool Push(Value&& value) {
+                if (remaining == 0) return false;
+                --remaining;
+                return downstream.Push(std::forward< Value >(value)) && remaining != 0;
+            }
+            void Finish() { downstream.Finish(); }
+        };
+
+        // Elements pushed into one stage of an evaluation, only counted when tracing is enabled
+        struct StageCounters {
+            std::size_t pushed = 0;
+            std::size_t bytes  = 0;
+        };
+
+        template < class Sink >
+        struct TracedSink {
+            StageCounters* counters;
+            Sink           sink;
+
+            template < class Value >
+            bool Push(Value&& value) {
+                ++counters->pushed;
+                return sink.Push(std::forward< Value >(value));
+            }
+            void Finish() {
+                if constexpr (requires { sink.AllocatedBytes(); }) counters->bytes = sink.AllocatedBytes();
+                sink.Finish();
+            }
+        };
+
+        // Operators only hold their arguments, Wrap builds the sink when the pipeline is evaluated
+        template < class Predicate >
+        struct WhereOperator {
+            static constexpr const char* name = "Where";
+
+            Predicate predicate;
+
+            template < class Type, class Allocator, class Downstream >
+            auto Wrap(Downstream&& downstream, const Allocator&) {
+                return WhereSink< Predicate, std::decay_t< Downstream > > { predicate, std::forward< Downstream >(downstream) };
+            }
+        };
+
+        template < class Functor >
+        struct SelectOperator {
+            static constexpr const char* name = "Select";
+
+            Functor functor;
+
+            template < class Type, class Allocator, class Downstream >
+            auto Wrap(Downstream&& downstream, const Allocator&) {
+                return SelectSink< Functor, std::decay_t< Downstream > > { functor, std::forward< Downstream >(downstream) };
+            }
+        };
+
+        template < class Comparator >
+        struct OrderByOperator {
+            static constexpr const char* name = "OrderBy";
+
+            Comparator comparator;
+
+            template < class Type, class Allocator, class Downstream >
+            auto Wrap(Downstream&& downstream, const Allocator& alloc) {
+                return OrderBySink< Type, Allocator, Comparator, std::decay_t< Downstream > > { comparator, std::forward< Downstream >(downstream),
+                                                                                                std::vector< Type, Allocator >(alloc) };
+            }
+        };
+
+        struct TakeOperator {
+            static constexpr const char* name = "Take";
+
+            std::size_t count;
+
+            template < class Type, class Allocator, class Downstream >
+            auto Wrap(Downstream&& downstream, const Allocator&) {
+                return TakeSink< std::decay_t< Downstream > > { count, std::forward< Downstream >(downstream) };
+            }
+        };
+
+        template < class Comparator >
+        struct TopNOperator {
+            static constexpr const char* name = "TakeOrdered";
+
+            Comparator  comparator;
+            std::size_t count;
+
+            template < class Type, class Allocator, class Downstream >
+            auto Wrap(Downstream&& downstream, const Allocator& alloc) {
+                return TopNSink< Type, Allocator, Comparator, std::decay_t< Downstream > > { comparator, count, std::forward< Downstream >(downstream),
+                                                                                             std::vector< Type, Allocator >(alloc) };
+            }
+        };
+
+        template < class >
+        struct IsOrderBy : std::false_type {};
+        template < class Comparator >
+        struct IsOrderBy< OrderByOperator< Comparator > > : std::true_type {};
+
+        template < class >
+        struct IsTopN : std::false_type {};
+        template < class Comparator >
+        struct IsTopN< TopNOperator< Comparator > > : std::true_type {};
+
+        template < class... Operators >
+        using LastOf = std::tuple_element_t< sizeof...(Operators) - 1, std::tuple< Operators... > >;
+
+        template < class Tuple, std::size_t... Indices >
+        auto DropLast(Tuple&& operators, std::index_sequence< Indices... >) {
+            return std::make_tuple(std::get< Indices >(std::move(operators))...);
+        }
+
+        // Terminal sinks
+        template < class Type >
+        struct AverageSink {
+            static constexpr bool reduces = true;
+
+            Type*        sum;
+            std::size_t* count;
+
+            template < class Value >
+            bool Push(Value&& value) {
+                *sum = std::move(*sum) + std::forward< Value >(value);
+                ++*count;
+                return true;
+            }
+            void Finish() {}
+        };
+
+        template < class Action >
+        struct ForEachSink {
+            Action* action;
+
+            template < class Value >
+            bool Push(Value&& value) {
+                (*action)(std::forward< Value >(value));
+                return true;
+            }
+            void Finish() {}
+        };
+
+        template < class Type >
+        struct FirstSink {
+            static constexpr bool reduces = true;
+
+            Type* result;
+
+            template < class Value >
+            bool Push(Value&& value) {
+                *result = std::forward< Value >(value);
+                return false;
+            }
+            void Finish() {}
+        };
+
+        template < class Container >
+        struct CollectSink {
+            Container* result;
+
+            template < class Value >
+            bool Push(Value&& value) {
+                result->emplace_back(std::forward< Value >(value));
+                return true;
+            }
+            void Finish() {}
+            [[nodiscard]] std::size_t AllocatedBytes() const noexcept { return result->capacity() * sizeof(typename Container::value_type); }
+        };
+
+        // Every operator knows the element type it receives, so the chain is built from the
+        // source element type forwards while the sinks are nested from the terminal backwards
+        template < class Type, class Operator >
+        struct OutputOf {
+            using type = Type;
+        };
+        template < class Type, class Functor >
+        struct OutputOf< Type, SelectOperator< Functor > > {
+            using type = std::invoke_result_t< Functor&, Type >;
+        };
+
+        // With tracing enabled every stage is wrapped to count into counters[Index]
+        template < class Type, class Allocator, std::size_t Index, class Operators, class Terminal >
+        auto BuildSink(Operators& operators, Terminal&& terminal, const Allocator& alloc, [[maybe_unused]] StageCounters* counters) {
+            if constexpr (Index == std::tuple_size_v< Operators >) {
+                return std::forward< Terminal >(terminal);
+            } else {
+                using Operator        = std::tuple_element_t< Index, Operators >;
+                using OutputType      = typename OutputOf< Type, Operator >::type;
+                using OutputAllocator = typename std::allocator_traits< Allocator >::template rebind_alloc< OutputType >;
+
+                auto sink = std::get< Index >(operators).template Wrap< Type, Allocator >(
+                    BuildSink< OutputType, OutputAllocator, Index + 1 >(operators, std::forward< Terminal >(terminal), OutputAllocator(alloc), counters),
+                    alloc);
+                if constexpr (trace::enabled) {
+                    return TracedSink< decltype(sink) > { counters + Index, std::move(sink) };
+                } else {
+                    return sink;
+                }
+            }
+        }
+
+    } // namespace impl::lazy
+
+    /// <summary>
+    /// Lazy view over a LinqContainer, obtained through LinqContainer::AsLazy()
+    /// Where/Select/OrderBy/Take only record themselves, the whole chain runs as one fused loop
+    /// when a terminal operator (Average, ForEach, FirstOrDefault, ToVector) is called.
+    /// Unlike LinqContainer::Take, Take(n) here yields at most n elements and never throws.
+    /// OrderBy directly followed by Take runs as a bounded heap (see TakeOrdered).
+    /// </summary>
+    /// <typeparam name="Type">Element type produced by the last recorded operator</typeparam>
+    /// <typeparam name="Allocator">Allocator used by the buffering operators and ToVector, its instance is propagated</typeparam>
+    template < class Type, class Allocator, class Source, class... Operators >
+    class LinqPipeline {
+      public:
+        using value_type     = Type;
+        using allocator_type = typename std::allocator_traits< Allocator >::template rebind_alloc< Type >;
+
+        LinqPipeline(Source source, std::tuple< Operators... > operators, const allocator_type& alloc = allocator_type {}) :
+            source(std::move(source)), operators(std::move(operators)), allocator(alloc) {}
+
+        [[nodiscard]] allocator_type get_allocator() const noexcept { return allocator; }
+
+        template < std::predicate< Type > Functor >
+        [[nodiscard]] auto Where(Functor&& func) && {
+            return Append< Type >(impl::lazy::WhereOperator< std::decay_t< Functor > > { std::forward< Functor >(func) });
+        }
+        template < std::predicate< Type > Functor >
+        [[nodiscard]] auto Where(Functor&& func) const& {
+            return LinqPipeline { *this }.Where(std::forward< Functor >(func));
+        }
+
+        template < class Functor, class Ret = std::invoke_result_t< std::decay_t< Functor >&, Type > >
+        [[nodiscard]] auto Select(Functor&& func) && {
+            return Append< Ret >(impl::lazy::SelectOperator< std::decay_t< Functor > > { std::forward< Functor >(func) });
+        }
+        template < class Functor >
+        [[nodiscard]] auto Select(Functor&& func) const& {
+            return LinqPipeline { *this }.Select(std::forward< Functor >(func));
+        }
+
+        template < std::predicate< Type, Type > Functor >
+        [[nodiscard]] auto OrderBy(Functor&& func) && {
+            return Append< Type >(impl::lazy::OrderByOperator< std::decay_t< Functor > > { std::forward< Functor >(func) });
+        }
+        template < std::predicate< Type, Type > Functor >
+        [[nodiscard]] auto OrderBy(Functor&& func) const& {
+            return LinqPipeline { *this }.OrderBy(std::forward< Functor >(func));
+        }
+
+        // OrderBy(...).Take(n) and TakeOrdered(m, ...).Take(n) are rewritten into a single top-n step
+        [[nodiscard]] auto Take(std::size_t size_) && {
+            if constexpr (sizeof...(Operators) == 0) {
+                return Append< Type >(impl::lazy::TakeOperator { size_ });
+            } else if constexpr (impl::lazy::IsOrderBy< impl::lazy::LastOf< Operators... > >::value) {
+                auto orderBy = std::get< sizeof...(Operators) - 1 >(std::move(operators));
+                return ReplaceLast(impl::lazy::TopNOperator< decltype(orderBy.comparator) > { std::move(orderBy.comparator), size_ });
+            } else if constexpr (impl::lazy::IsTopN< impl::lazy::LastOf< Operators... > >::value) {
+                auto topN = std::get< sizeof...(Operators) - 1 >(std::move(operators));
+                return ReplaceLast(impl::lazy::TopNOperator< decltype(topN.comparator) > { std::move(topN.comparator), std::min(topN.count, size_) });
+            } else {
+                return Append< Type >(impl::lazy::TakeOperator { size_ });
+            }
+        }
+        [[nodiscard]] auto Take(std::size_t size_) const& { return LinqPipeline { *this }.Take(size_); }
+
+        // Equivalent to OrderBy(func).Take(size_)
+        template < std::predicate< Type, Type > Functor >
+        [[nodiscard]] auto TakeOrdered(std::size_t size_, Functor&& func) && {
+            return Append< Type >(impl::lazy::TopNOperator< std::decay_t< Functor > > { std::forward< Functor >(func), size_ });
+        }
+        template < std::predicate< Type, Type > Functor >
+        [[nodiscard]] auto TakeOrdered(std::size_t size_, Functor&& func) const& {
+            return LinqPipeline { *this }.TakeOrdered(size_, std::forward< Functor >(func));
+        }
+
+        // Terminal operators
+        // Integers are summed in 64 bits and averaged in double instead of truncating, see fp::average_t
+        [[nodiscard]] average_t< Type > Average() requires addable< Type >&& dividable< Type > {
+            sum_t< Type > sum   = sum_t< Type >(0);
+            std::size_t   count = 0;
+            Evaluate("Average", impl::lazy::AverageSink< sum_t< Type > > { &sum, &count });
+
+            if constexpr (std::is_arithmetic_v< Type >) {
+                using Quotient = std::conditional_t< std::is_integral_v< Type >, double, sum_t< Type > >;
+                return static_cast< average_t< Type > >(static_cast< Quotient >(sum) / static_cast< Quotient >(count));
+            } else {
+                return sum / count;
+            }
+        }
+
+        template < class TAction >
+        auto ForEach(TAction&& func) -> void requires(std::same_as< std::invoke_result_t< TAction, Type >, void >) {
+            Evaluate("ForEach", impl::lazy::ForEachSink< std::remove_reference_t< TAction > > { &func });
+        }
+
+        [[nodiscard]] Type FirstOrDefault() {
+            Type result {};
+            Evaluate("FirstOrDefault", impl::lazy::FirstSink< Type > { &result });
+
+            return result;
+        }
+
+        [[nodiscard]] auto ToVector() -> std::vector< Type, allocator_type > {
+            std::vector< Type, allocator_type > result(allocator);
+            Evaluate("ToVector", impl::lazy::CollectSink< std::vector< Type, allocator_type > > { &result });
+
+            return result;
+        }
+
+        template < class OtherType, class OtherAllocator, class OtherSource, class... OtherOperators >
+        friend class LinqPipeline;
+
+      private:
+        using SourceType      = typename Source::value_type;
+        using SourceAllocator = typename std::allocator_traits< Allocator >::template rebind_alloc< SourceType >;
+
+        template < class NewType, class Operator >
+        auto Append(Operator&& op) {
+            using NewAllocator = typename std::allocator_traits< Allocator >::template rebind_alloc< NewType >;
+            return LinqPipeline< NewType, NewAllocator, Source, Operators..., std::decay_t< Operator > > {
+                std::move(source), std::tuple_cat(std::move(operators), std::make_tuple(std::forward< Operator >(op))), NewAllocator(allocator)
+            };
+        }
+
+        template < class Operator >
+        auto ReplaceLast(Operator&& op) {
+            auto kept = impl::lazy::DropLast(std::move(operators), std::make_index_sequence< sizeof...(Operators) - 1 > {});
+            return std::apply(
+                [&](auto&&... keptOperators) {
+                    return LinqPipeline< Type, Allocator, Source, std::decay_t< decltype(keptOperators) >..., std::decay_t< Operator > > {
+                        std::move(source), std::make_tuple(std::move(keptOperators)..., std::forward< Operator >(op)), allocator
+                    };
+                },
+                std::move(kept));
+        }
+
+        template < class Terminal >
+        void Evaluate([[maybe_unused]] const char* terminalName, Terminal&& terminal) {
+            if constexpr (trace::enabled) {
+                // Stages are fused: each one reports its counts, the terminal reports the time of the whole loop
+                std::array< impl::lazy::StageCounters, sizeof...(Operators) + 1 > counters {};
+                auto*                                                            collector = trace::Current();
+                const auto                                                       start     = collector != nullptr ? collector->Now() : 0;
+                trace::OperatorScope scope { terminalName, 0, sizeof...(Operators) }; // Recorded last, after its stages
+                auto sink = impl::lazy::BuildSink< SourceType, SourceAllocator, 0 >(
+                    operators, impl::lazy::TracedSink< std::decay_t< Terminal > > { &counters.back(), std::forward< Terminal >(terminal) },
+                    SourceAllocator(allocator), counters.data());
+                source.Push(sink);
+                sink.Finish();
+                const auto reaching = counters.back().pushed;
+                scope.Input(reaching);
+                if constexpr (requires { std::decay_t< Terminal >::reduces; }) {
+                    scope.Output(std::min< std::size_t >(reaching, 1), counters.back().bytes);
+                } else {
+                    scope.Output(reaching, counters.back().bytes);
+                }
+
+                if (collector == nullptr) return;
+                const auto names = std::array< const char*, sizeof...(Operators) > { Operators::name... };
+                for (std::size_t stage = 0; stage < names.size(); ++stage) {
+                    collector->Record(trace::Event { names[stage], stage, counters[stage].pushed, counters[stage + 1].pushed, counters[stage].bytes, start, 0,
+                                                     trace::impl::ThreadIndex() });
+                }
+            } else {
+                auto sink = impl::lazy::BuildSink< SourceType, SourceAllocator, 0 >(operators, std::forward< Terminal >(terminal), SourceAllocator(allocator),
+                                                                                  nullptr);
+                source.Push(sink);
+                sink.Finish();
+            }
+        }
+
+        Source                     source;
+        std::tuple< Operators... > operators;
+        allocator_type             allocator;
+    };
+
+} // namespace fp
+
+#endif // LINQ_PIPELINE
@@ -0,0 +1,149 @@
+// Lookup.hpp: Enum-indexed lookup containers
+//
+// Keys are enumerators with a known number of values, the enumerator is the index into a flat array,
+// so a lookup is a bounds check and a load: no hashing, no probing, no allocation.
+
+#ifndef LOOKUP_FP
+#define LOOKUP_FP
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace fp {
+
+    // Number of enumerators of Enum. Enums with a trailing Count enumerator get it for free,
+    // others specialize it: template <> struct fp::enum_size< MyEnum > : std::integral_constant< std::size_t, 4 > {};
+    template < class Enum >
+    struct enum_size {};
+    template < class Enum >
+    requires std::is_enum_v< Enum > && requires { Enum::Count; }
+    struct enum_size< Enum > : std::integral_constant< std::size_t, static_cast< std::size_t >(Enum::Count) > {};
+
+    template < class Enum >
+    concept indexable_enum = std::is_enum_v< Enum > && requires {
+        { enum_size< Enum >::value } -> std::convertible_to< std::size_t >;
+    };
+
+    namespace impl {
+        template < indexable_enum Key >
+        constexpr std::size_t EnumIndex(Key key) noexcept {
+            return static_cast< std::size_t >(static_cast< std::underlying_type_t< Key > >(key));
+        }
+    } // namespace impl
+
+    /// <summary>
+    /// Dictionary from enumerators to values stored as a flat array
+    /// Enumerators must lie in [0, enum_size< Key >), others are never found
+    /// </summary>
+    template < indexable_enum Key, class Value >
+    class EnumDictionary {
+      public:
+        using key_type    = Key;
+        using mapped_type = Value;
+        using size_type   = std::size_t;
+
+        static constexpr size_type capacity = enum_size< Key >::value;
+
+        EnumDictionary() = default;
+
+        // Returns false and leaves the dictionary unchanged when the key is already present
+        bool TryAdd(Key key, Value value) {
+            const auto index = impl::EnumIndex(key);
+            if (index >= capacity) throw std::out_of_range { "Enumerator is outside of the dictionary" };
+            if (present[index]) return false;
+
+            values[index]  = std::move(value);
+            present[index] = true;
+            ++count;
+            return true;
+        }
+
+        [[nodiscard]] const Value* Find(Key key) const noexcept {
+            const auto index = impl::EnumIndex(key);
+            return index < capacity && present[index] ? &values[index] : nullptr;
+        }
+
+        [[nodiscard]] Value FindOrDefault(Key key) const {
+            const auto* value = Find(key);
+            return value != nullptr ? *value : Value {};
+        }
+
+        [[nodiscard]] const Value& at(Key key) const {
+            const auto* value = Find(key);
+            if (value == nullptr) throw std::out_of_range { "Key is not in the dictionary" };
+            return *value;
+        }
+
+        [[nodiscard]] bool      contains(Key key) const noexcept { return Find(key) != nullptr; }
+        [[nodiscard]] size_type size() const noexcept { return count; }
+        [[nodiscard]] bool      empty() const noexcept { return count == 0; }
+
+      private:
+        std::array< Value, capacity > values {};
+        std::array< bool, capacity >  present {};
+        size_type                     count = 0;
+    };
+
+    /// <summary>
+    /// One-to-many lookup from enumerators to values, built once
+    /// Values are grouped by key in one contiguous array (in source order), each key owns a span of it
+    /// </summary>
+    template < indexable_enum Key, class Value, class Allocator = std::allocator< Value > >
+    class EnumLookup {
+      public:
+        using key_type    = Key;
+        using mapped_type = Value;
+        using size_type   = std::size_t;
+
+        static constexpr size_type capacity = enum_size< Key >::value;
+
+        explicit EnumLookup(const Allocator& alloc = Allocator {}) : values(alloc) {}
+
+        // Counting sort of the elements by key: one pass to size the groups, one to place the values
+        template < class Range, class KeySelector, class ValueSelector >
+        EnumLookup(const Range& elements, KeySelector&& keySelector, ValueSelector&& valueSelector, const Allocator& alloc = Allocator {}) : values(alloc) {
+            for (const auto& element : elements) {
+                const auto index = impl::EnumIndex(static_cast< Key >(std::invoke(keySelector, element)));
+                if (index >= capacity) throw std::out_of_range { "Enumerator is outside of the lookup" };
+                ++offsets[index + 1];
+            }
+            for (size_type i = 0; i < capacity; ++i) { offsets[i + 1] += offsets[i]; }
+
+            // Elements in key order, then the values are constructed from them in that order
+            using Element          = std::remove_cvref_t< std::ranges::range_reference_t< const Range > >;
+            using ElementAllocator = typename std::allocator_traits< Allocator >::template rebind_alloc< const Element* >;
+            std::vector< const Element*, ElementAllocator > ordered(offsets[capacity], nullptr, ElementAllocator(alloc));
+            auto                                            next = offsets;
+            for (const auto& element : elements) { ordered[next[impl::EnumIndex(static_cast< Key >(std::invoke(keySelector, element)))]++] = &element; }
+
+            values.reserve(ordered.size());
+            for (const auto* element : ordered) { values.emplace_back(std::invoke(valueSelector, *element)); }
+        }
+
+        // Values of key, empty when the key has none
+        [[nodiscard]] std::span< const Value > operator[](Key key) const noexcept {
+            const auto index = impl::EnumIndex(key);
+            if (index >= capacity) return {};
+            return { values.data() + offsets[index], offsets[index + 1] - offsets[index] };
+        }
+
+        [[nodiscard]] bool      contains(Key key) const noexcept { return !(*this)[key].empty(); }
+        [[nodiscard]] size_type size() const noexcept { return values.size(); }
+
+      private:
+        std::array< size_type, capacity + 1 > offsets {};
+        std::vector< Value, Allocator >       values;
+    };
+
+} // namespace fp
+
+#endif // LOOKUP_FP
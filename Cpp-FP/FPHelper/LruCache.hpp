@@ -0,0 +1,139 @@
+// LruCache.hpp: Thread-safe bounded cache with least-recently-used eviction
+//
+// Values are built by a factory on a miss and shared as std::shared_ptr< const Value >, so a value handed
+// out stays alive after it is evicted. Lookups and insertions are O(1) under a single mutex; the factory
+// runs outside of it, concurrent misses on the same key may both build and the first insertion wins.
+
+#ifndef LRU_CACHE_FP
+#define LRU_CACHE_FP
+
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+
+namespace fp {
+
+    template < class Key, class Value, class Hash = std::hash< Key >, class KeyEqual = std::equal_to< Key > >
+    class LruCache {
+      public:
+        using key_type      = Key;
+        using value_type    = Value;
+        using value_pointer = std::shared_ptr< const Value >;
+        using size_type     = std::size_t;
+
+        explicit LruCache(size_type capacity_) : capacity(capacity_) {
+            if (capacity == 0) throw std::invalid_argument { "LruCache capacity must be at least 1" };
+            index.reserve(capacity);
+        }
+
+        LruCache(const LruCache&) = delete;
+        LruCache& operator=(const LruCache&) = delete;
+
+        // Cached value of key, or nullptr. A hit makes the entry the most recently used
+        [[nodiscard]] value_pointer Find(const Key& key) {
+            std::lock_guard lock { mutex };
+            return FindLocked(key);
+        }
+
+        // Cached value of key, built with factory() and cached on a miss. Exceptions from factory propagate and cache nothing
+        template < class Factory >
+        requires std::is_convertible_v< std::invoke_result_t< Factory& >, Value >
+        [[nodiscard]] value_pointer GetOrAdd(const Key& key, Factory&& factory) {
+            {
+                std::lock_guard lock { mutex };
+                if (auto value = FindLocked(key)) return value;
+            }
+
+            auto built = std::make_shared< const Value >(factory());
+
+            std::lock_guard lock { mutex };
+            if (auto existing = index.find(key); existing != index.end()) {
+                entries.splice(entries.begin(), entries, existing->second);
+                return existing->second->second;
+            }
+            InsertLocked(key, built);
+            return built;
+        }
+
+        // Inserts or replaces the value of key
+        void Put(const Key& key, Value value) {
+            auto            built = std::make_shared< const Value >(std::move(value));
+            std::lock_guard lock { mutex };
+            if (auto existing = index.find(key); existing != index.end()) {
+                existing->second->second = std::move(built);
+                entries.splice(entries.begin(), entries, existing->second);
+                return;
+            }
+            InsertLocked(key, std::move(built));
+        }
+
+        bool Erase(const Key& key) {
+            std::lock_guard lock { mutex };
+            const auto      existing = index.find(key);
+            if (existing == index.end()) return false;
+            entries.erase(existing->second);
+            index.erase(existing);
+            return true;
+        }
+
+        void Clear() {
+            std::lock_guard lock { mutex };
+            entries.clear();
+            index.clear();
+        }
+
+        [[nodiscard]] size_type size() const {
+            std::lock_guard lock { mutex };
+            return index.size();
+        }
+        [[nodiscard]] size_type Capacity() const noexcept { return capacity; }
+        [[nodiscard]] size_type Hits() const {
+            std::lock_guard lock { mutex };
+            return hits;
+        }
+        [[nodiscard]] size_type Misses() const {
+            std::lock_guard lock { mutex };
+            return misses;
+        }
+
+      private:
+        // Most recently used first
+        using Entries = std::list< std::pair< Key, value_pointer > >;
+
+        value_pointer FindLocked(const Key& key) {
+            const auto existing = index.find(key);
+            if (existing == index.end()) {
+                ++misses;
+                return nullptr;
+            }
+            ++hits;
+            entries.splice(entries.begin(), entries, existing->second);
+            return existing->second->second;
+        }
+
+        void InsertLocked(const Key& key, value_pointer value) {
+            if (index.size() == capacity) {
+                index.erase(entries.back().first);
+                entries.pop_back();
+            }
+            entries.emplace_front(key, std::move(value));
+            index.emplace(key, entries.begin());
+        }
+
+        const size_type                                                         capacity;
+        mutable std::mutex                                                      mutex {};
+        Entries                                                                 entries {};
+        std::unordered_map< Key, typename Entries::iterator, Hash, KeyEqual > index {};
+        size_type                                                               hits   = 0;
+        size_type                                                               misses = 0;
+    };
+
+} // namespace fp
+
+#endif // LRU_CACHE_FP
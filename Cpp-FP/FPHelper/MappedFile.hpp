@@ -0,0 +1,156 @@
+// MappedFile.hpp: Read-only memory mapped file, used to query record dumps in place
+
+#ifndef MAPPED_FILE_FP
+#define MAPPED_FILE_FP
+
+#include <cerrno>
+#include <cstddef>
+#include <filesystem>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#if defined(_WIN32)
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace fp {
+
+    /// <summary>
+    /// Maps a whole file read-only into memory for the lifetime of the object
+    /// Throws std::system_error when the file cannot be opened or mapped
+    /// </summary>
+    class MappedFile {
+      public:
+        explicit MappedFile(const std::filesystem::path& path) { Map(path); }
+        ~MappedFile() { Unmap(); }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        MappedFile(MappedFile&& other) noexcept : mData(std::exchange(other.mData, nullptr)), mSize(std::exchange(other.mSize, 0)) {}
+        MappedFile& operator=(MappedFile&& other) noexcept {
+            if (this != &other) {
+                Unmap();
+                mData = std::exchange(other.mData, nullptr);
+                mSize = std::exchange(other.mSize, 0);
+            }
+            return *this;
+        }
+
+        [[nodiscard]] const std::byte* data() const noexcept { return mData; }
+        [[nodiscard]] std::size_t      size() const noexcept { return mSize; }
+
+        // Views the mapping as an array of records, the file size must be a multiple of the record size
+        template < class Record >
+        requires std::is_trivially_copyable_v< Record >
+        [[nodiscard]] std::span< const Record > As() const {
+            if (mSize % sizeof(Record) != 0) throw std::length_error { "Mapped file size is not a multiple of the record size" };
+            return { reinterpret_cast< const Record* >(mData), mSize / sizeof(Record) };
+        }
+
+      private:
+#if defined(_WIN32)
+        void Map(const std::filesystem::path& path) {
+            const auto file = ::CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+            if (file == INVALID_HANDLE_VALUE) ThrowLastError("Cannot open " + path.string());
+
+            LARGE_INTEGER fileSize {};
+            if (!::GetFileSizeEx(file, &fileSize)) {
+                const auto error = ::GetLastError();
+                ::CloseHandle(file);
+                throw std::system_error { static_cast< int >(error), std::system_category(), "Cannot read the size of " + path.string() };
+            }
+            mSize = static_cast< std::size_t >(fileSize.QuadPart);
+            if (mSize == 0) {
+                ::CloseHandle(file);
+                return;
+            }
+
+            const auto mapping = ::CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            const auto error   = ::GetLastError();
+            ::CloseHandle(file);
+            if (mapping == nullptr) {
+                mSize = 0;
+                throw std::system_error { static_cast< int >(error), std::system_category(), "Cannot map " + path.string() };
+            }
+
+            // The view keeps the mapping object alive
+            const auto* view      = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            const auto  viewError = ::GetLastError();
+            ::CloseHandle(mapping);
+            if (view == nullptr) {
+                mSize = 0;
+                throw std::system_error { static_cast< int >(viewError), std::system_category(), "Cannot map " + path.string() };
+            }
+            mData = static_cast< const std::byte* >(view);
+        }
+
+        void Unmap() noexcept {
+            if (mData != nullptr) ::UnmapViewOfFile(static_cast< LPCVOID >(mData));
+            mData = nullptr;
+            mSize = 0;
+        }
+
+        [[noreturn]] static void ThrowLastError(const std::string& what) {
+            throw std::system_error { static_cast< int >(::GetLastError()), std::system_category(), what };
+        }
+#else
+        void Map(const std::filesystem::path& path) {
+            const auto file = ::open(path.c_str(), O_RDONLY);
+            if (file < 0) ThrowLastError("Cannot open " + path.string());
+
+            struct stat status {};
+            if (::fstat(file, &status) != 0) {
+                const auto error = errno;
+                ::close(file);
+                throw std::system_error { error, std::generic_category(), "Cannot read the size of " + path.string() };
+            }
+            mSize = static_cast< std::size_t >(status.st_size);
+            if (mSize == 0) {
+                ::close(file);
+                return;
+            }
+
+            // The mapping stays valid after the descriptor is closed
+            auto* mapping = ::mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, file, 0);
+            if (mapping == MAP_FAILED) {
+                const auto error = errno;
+                ::close(file);
+                mSize = 0;
+                throw std::system_error { error, std::generic_category(), "Cannot map " + path.string() };
+            }
+            ::close(file);
+            ::madvise(mapping, mSize, MADV_SEQUENTIAL);
+            mData = static_cast< const std::byte* >(mapping);
+        }
+
+        void Unmap() noexcept {
+            if (mData != nullptr) ::munmap(const_cast< std::byte* >(mData), mSize);
+            mData = nullptr;
+            mSize = 0;
+        }
+
+        [[noreturn]] static void ThrowLastError(const std::string& what) { throw std::system_error { errno, std::generic_category(), what }; }
+#endif
+
+        const std::byte* mData = nullptr;
+        std::size_t      mSize = 0;
+    };
+
+} // namespace fp
+
+#endif // MAPPED_FILE_FP
@@ -0,0 +1,217 @@
+// Simd.hpp: Reduction and mask kernels over contiguous columns of numbers
+//
+// Kernels keep one accumulator per vector lane and reduce them at the end, so floating point sums are
+// reassociated and may differ in the last bits from a sequential loop. Min/Max assume no NaN.
+// Double columns use intrinsics for the widest instruction set the build enables (SSE2 is the x86-64
+// baseline, build with -mavx2 / -march=native or FP_ENABLE_NATIVE_ARCH for 4-8 lanes), every other
+// type uses the lane-blocked portable loops which compilers vectorize on their own.
+// long double has no vector instructions on x86-64, store columns as double or float.
+
+#ifndef SIMD_FP
+#define SIMD_FP
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <type_traits>
+#include <Traits.hpp>
+
+#if defined(__AVX512F__) || defined(__AVX__) || defined(__SSE2__) || defined(_M_X64)
+    #include <immintrin.h>
+    #define FP_SIMD_DOUBLE_VECTOR
+#endif
+
+namespace fp::simd {
+
+    template < class Type >
+    concept lane_type = std::is_arithmetic_v< Type > && !std::same_as< Type, long double > && !std::same_as< Type, bool >;
+
+    namespace impl {
+
+        // Elements processed per iteration by the portable loops, one 32 bytes vector
+        template < class Type >
+        inline constexpr std::size_t lanes = 32 / sizeof(Type) > 0 ? 32 / sizeof(Type) : 1;
+
+#if defined(__AVX512F__)
+        struct DoubleVector {
+            using type                        = __m512d;
+            static constexpr std::size_t width = 8;
+            static type Load(const double* data) noexcept { return _mm512_loadu_pd(data); }
+            static type Set(double value) noexcept { return _mm512_set1_pd(value); }
+            static type Add(type a, type b) noexcept { return _mm512_add_pd(a, b); }
+            static type Min(type a, type b) noexcept { return _mm512_min_pd(a, b); }
+            static type Max(type a, type b) noexcept { return _mm512_max_pd(a, b); }
+            static void Store(double* data, type value) noexcept { _mm512_storeu_pd(data, value); }
+        };
+#elif defined(__AVX__)
+        struct DoubleVector {
+            using type                        = __m256d;
+            static constexpr std::size_t width = 4;
+            static type Load(const double* data) noexcept { return _mm256_loadu_pd(data); }
+            static type Set(double value) noexcept { return _mm256_set1_pd(value); }
+            static type Add(type a, type b) noexcept { return _mm256_add_pd(a, b); }
+            static type Min(type a, type b) noexcept { return _mm256_min_pd(a, b); }
+            static type Max(type a, type b) noexcept { return _mm256_max_pd(a, b); }
+            static void Store(double* data, type value) noexcept { _mm256_storeu_pd(data, value); }
+        };
+#elif defined(__SSE2__) || defined(_M_X64)
+        struct DoubleVector {
+            using type                        = __m128d;
+            static constexpr std::size_t width = 2;
+            static type Load(const double* data) noexcept { return _mm_loadu_pd(data); }
+            static type Set(double value) noexcept { return _mm_set1_pd(value); }
+            static type Add(type a, type b) noexcept { return _mm_add_pd(a, b); }
+            static type Min(type a, type b) noexcept { return _mm_min_pd(a, b); }
+            static type Max(type a, type b) noexcept { return _mm_max_pd(a, b); }
+            static void Store(double* data, type value) noexcept { _mm_storeu_pd(data, value); }
+        };
+#endif
+
+        // Folds values into two vector accumulators (hiding the add latency), then the lanes, then the tail
+        template < class Vector, class Operation, class Scalar >
+        double ReduceDouble(std::span< const double > values, double identity, Operation operation, Scalar scalar) noexcept {
+            constexpr auto width = Vector::width;
+
+            auto        first  = Vector::Set(identity);
+            auto        second = Vector::Set(identity);
+            std::size_t i      = 0;
+            for (; i + 2 * width <= values.size(); i += 2 * width) {
+                first  = operation(first, Vector::Load(values.data() + i));
+                second = operation(second, Vector::Load(values.data() + i + width));
+            }
+            for (; i + width <= values.size(); i += width) { first = operation(first, Vector::Load(values.data() + i)); }
+
+            std::array< double, width > partial {};
+            Vector::Store(partial.data(), operation(first, second));
+            auto result = identity;
+            for (const auto lane : partial) { result = scalar(result, lane); }
+            for (; i < values.size(); ++i) { result = scalar(result, values[i]); }
+            return result;
+        }
+
+        template < class Type, class Operation >
+        Type Reduce(std::span< const Type > values, Type identity, Operation operation) noexcept {
+            constexpr auto width = lanes< Type >;
+
+            std::array< Type, width > accumulators;
+            accumulators.fill(identity);
+            std::size_t i = 0;
+            for (; i + width <= values.size(); i += width) {
+                for (std::size_t lane = 0; lane < width; ++lane) { accumulators[lane] = operation(accumulators[lane], values[i + lane]); }
+            }
+
+            auto result = identity;
+            for (const auto accumulator : accumulators) { result = operation(result, accumulator); }
+            for (; i < values.size(); ++i) { result = operation(result, values[i]); }
+            return result;
+        }
+
+        template < class Type >
+        constexpr Type Highest() noexcept {
+            if constexpr (std::numeric_limits< Type >::has_infinity) return std::numeric_limits< Type >::infinity();
+            else
+                return std::numeric_limits< Type >::max();
+        }
+
+        template < class Type >
+        constexpr Type Lowest() noexcept {
+            if constexpr (std::numeric_limits< Type >::has_infinity) return -std::numeric_limits< Type >::infinity();
+            else
+                return std::numeric_limits< Type >::lowest();
+        }
+
+    } // namespace impl
+
+    // Integers are summed in their own type, widen the column first if it can overflow
+    template < lane_type Type >
+    [[nodiscard]] Type Sum(std::span< const Type > values) noexcept {
+#ifdef FP_SIMD_DOUBLE_VECTOR
+        if constexpr (std::same_as< Type, double >) {
+            using Vector = impl::DoubleVector;
+            return impl::ReduceDouble< Vector >(
+                values, 0.0, [](auto a, auto b) { return Vector::Add(a, b); }, [](double a, double b) { return a + b; });
+        } else
+#endif
+            return impl::Reduce(values, Type(0), [](Type a, Type b) -> Type { return a + b; });
+    }
+
+    // Sum accumulated in fp::sum_t< Type > (64 bits for integers, double for float), so it does not overflow or lose the
+    // low bits of float. Every lane widens its values before adding them, compilers vectorize it into widening adds
+    template < lane_type Type >
+    [[nodiscard]] sum_t< Type > WideSum(std::span< const Type > values) noexcept {
+        using Wide = sum_t< Type >;
+        if constexpr (std::same_as< Type, Wide >) {
+            return Sum(values);
+        } else {
+            constexpr auto width = impl::lanes< Type >;
+
+            std::array< Wide, width > accumulators {};
+            std::size_t               i = 0;
+            for (; i + width <= values.size(); i += width) {
+                for (std::size_t lane = 0; lane < width; ++lane) { accumulators[lane] += static_cast< Wide >(values[i + lane]); }
+            }
+
+            Wide result = 0;
+            for (const auto accumulator : accumulators) { result += accumulator; }
+            for (; i < values.size(); ++i) { result += static_cast< Wide >(values[i]); }
+            return result;
+        }
+    }
+
+    // Average of an empty column is NaN
+    template < lane_type Type >
+    requires std::floating_point< Type >
+    [[nodiscard]] Type Average(std::span< const Type > values) noexcept {
+        return Sum(values) / static_cast< Type >(values.size());
+    }
+
+    // Minimum of an empty column is +infinity (the largest value for integers)
+    template < lane_type Type >
+    [[nodiscard]] Type Min(std::span< const Type > values) noexcept {
+#ifdef FP_SIMD_DOUBLE_VECTOR
+        if constexpr (std::same_as< Type, double >) {
+            using Vector = impl::DoubleVector;
+            return impl::ReduceDouble< Vector >(
+                values, impl::Highest< double >(), [](auto a, auto b) { return Vector::Min(a, b); }, [](double a, double b) { return std::min(a, b); });
+        } else
+#endif
+            return impl::Reduce(values, impl::Highest< Type >(), [](Type a, Type b) { return std::min(a, b); });
+    }
+
+    // Maximum of an empty column is -infinity (the lowest value for integers)
+    template < lane_type Type >
+    [[nodiscard]] Type Max(std::span< const Type > values) noexcept {
+#ifdef FP_SIMD_DOUBLE_VECTOR
+        if constexpr (std::same_as< Type, double >) {
+            using Vector = impl::DoubleVector;
+            return impl::ReduceDouble< Vector >(
+                values, impl::Lowest< double >(), [](auto a, auto b) { return Vector::Max(a, b); }, [](double a, double b) { return std::max(a, b); });
+        } else
+#endif
+            return impl::Reduce(values, impl::Lowest< Type >(), [](Type a, Type b) { return std::max(a, b); });
+    }
+
+    /// <summary>
+    /// Writes predicate(values[i]) as 0/1 into mask[i] and returns how many are set.
+    /// The loop is branchless, a plain comparison predicate vectorizes into a compare and a pack.
+    /// mask must hold at least values.size() elements.
+    /// </summary>
+    template < lane_type Type, class Predicate >
+    requires std::predicate< Predicate&, Type >
+    std::size_t Mask(std::span< const Type > values, std::span< std::uint8_t > mask, Predicate&& predicate) {
+        std::size_t count = 0;
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            const auto selected = static_cast< std::uint8_t >(predicate(values[i]) ? 1 : 0);
+            mask[i]             = selected;
+            count += selected;
+        }
+        return count;
+    }
+
+} // namespace fp::simd
+
+#endif // SIMD_FP
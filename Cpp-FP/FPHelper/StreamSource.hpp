@@ -0,0 +1,122 @@
+// StreamSource.hpp: Streaming sources for the lazy LinqPipeline
+// Records are pulled in fixed-size chunks and pushed through the operator chain one chunk at a time,
+// so the memory held by the source is bounded by the chunk size rather than the input size
+
+#ifndef STREAM_SOURCE_FP
+#define STREAM_SOURCE_FP
+
+#include <LinqPipeline.hpp>
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace fp {
+
+    namespace impl::stream {
+
+        // Reads binary records from a C stream, shared so that copies of a pipeline read the same stream
+        template < class Type >
+        struct FileReader {
+            std::shared_ptr< std::FILE > file;
+
+            bool Fill(std::vector< Type >& chunk, std::size_t chunkSize) {
+                chunk.resize(chunkSize);
+                const auto bytes = std::fread(chunk.data(), 1, chunkSize * sizeof(Type), file.get());
+                if (std::ferror(file.get())) throw std::runtime_error { "Failed to read from the record stream" };
+                if (bytes % sizeof(Type) != 0) throw std::length_error { "Record stream ended in the middle of a record" };
+
+                chunk.resize(bytes / sizeof(Type));
+                return !chunk.empty();
+            }
+        };
+
+        template < class Type, class Generator >
+        struct GeneratorReader {
+            Generator generator;
+            bool      exhausted = false;
+
+            bool Fill(std::vector< Type >& chunk, std::size_t chunkSize) {
+                chunk.clear();
+                while (!exhausted && chunk.size() < chunkSize) {
+                    std::optional< Type > next = generator();
+                    if (!next) {
+                        exhausted = true;
+                        break;
+                    }
+                    chunk.emplace_back(std::move(*next));
+                }
+                return !chunk.empty();
+            }
+        };
+
+    } // namespace impl::stream
+
+    /// <summary>
+    /// LinqPipeline source pulling records chunk by chunk through Reader::Fill(chunk, chunkSize)
+    /// Streams are single pass: evaluating a pipeline consumes its stream.
+    /// </summary>
+    template < class Type, class Reader >
+    struct ChunkedSource {
+        using value_type = Type;
+
+        Reader      reader;
+        std::size_t chunkSize;
+
+        template < class Sink >
+        void Push(Sink& sink) {
+            std::vector< Type > chunk {};
+            chunk.reserve(chunkSize);
+            while (reader.Fill(chunk, chunkSize)) {
+                for (auto& element : chunk) {
+                    if (!sink.Push(std::move(element))) return;
+                }
+            }
+        }
+    };
+
+    template < class Type >
+    struct Stream {
+        static constexpr std::size_t default_chunk_size = 64 * 1024 / sizeof(Type) > 0 ? 64 * 1024 / sizeof(Type) : 1;
+
+        // Streams a file of trivially copyable records
+        [[nodiscard]] static auto FromFile(const std::filesystem::path& path, std::size_t chunkSize = default_chunk_size)
+            requires std::is_trivially_copyable_v< Type > {
+            auto* file = std::fopen(path.string().c_str(), "rb");
+            if (file == nullptr) throw std::system_error { errno, std::generic_category(), "Cannot open " + path.string() };
+
+            return Make(impl::stream::FileReader< Type > { std::shared_ptr< std::FILE > { file, [](std::FILE* f) { std::fclose(f); } } }, chunkSize);
+        }
+
+        // Streams records from an already open C stream (stdin, a popen'd pipe...) which stays owned by the caller
+        [[nodiscard]] static auto FromStream(std::FILE* stream, std::size_t chunkSize = default_chunk_size) requires std::is_trivially_copyable_v< Type > {
+            return Make(impl::stream::FileReader< Type > { std::shared_ptr< std::FILE > { stream, [](std::FILE*) {} } }, chunkSize);
+        }
+
+        // Streams the values returned by generator() until it returns an empty optional
+        template < class Generator >
+        requires std::is_convertible_v< std::invoke_result_t< Generator& >, std::optional< Type > >
+        [[nodiscard]] static auto FromGenerator(Generator&& generator, std::size_t chunkSize = default_chunk_size) {
+            return Make(impl::stream::GeneratorReader< Type, std::decay_t< Generator > > { std::forward< Generator >(generator) }, chunkSize);
+        }
+
+      private:
+        template < class Reader >
+        static auto Make(Reader&& reader, std::size_t chunkSize) {
+            using Source = ChunkedSource< Type, std::decay_t< Reader > >;
+            return LinqPipeline< Type, std::allocator< Type >, Source > { Source { std::forward< Reader >(reader), std::max< std::size_t >(chunkSize, 1) }, {} };
+        }
+    };
+
+} // namespace fp
+
+#endif // STREAM_SOURCE_FP
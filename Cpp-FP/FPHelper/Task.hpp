@@ -0,0 +1,371 @@
+// Task.hpp: C++20 coroutine tasks on the TaskScheduler and asynchronous composition
+//
+// A Task< T > is lazy: its body starts when it is awaited and, when it completes, resumes its awaiter
+// directly (symmetric transfer). co_await ScheduleOn(scheduler) moves the rest of a coroutine onto a
+// worker, this is how a stage that waits for I/O hands its thread back instead of blocking it.
+// WhenAll runs many tasks concurrently on the scheduler and SyncWait blocks a plain thread on a task
+// while helping the scheduler, like TaskGroup::Wait.
+
+#ifndef TASK_FP
+#define TASK_FP
+
+#include <TaskScheduler.hpp>
+#include <Traits.hpp>
+#include <atomic>
+#include <concepts>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace fp {
+
+    template < class Type = void >
+    class Task;
+
+    namespace impl {
+
+        struct TaskPromiseBase {
+            struct FinalAwaiter {
+                bool await_ready() const noexcept { return false; }
+                template < class Promise >
+                std::coroutine_handle<> await_suspend(std::coroutine_handle< Promise > handle) const noexcept {
+                    return handle.promise().continuation;
+                }
+                void await_resume() const noexcept {}
+            };
+
+            std::suspend_always initial_suspend() const noexcept { return {}; }
+            FinalAwaiter        final_suspend() const noexcept { return {}; }
+
+            std::coroutine_handle<> continuation = std::noop_coroutine();
+        };
+
+        template < class Type >
+        struct TaskPromise : TaskPromiseBase {
+            Task< Type > get_return_object() noexcept;
+
+            template < class Value >
+            requires std::convertible_to< Value&&, Type >
+            void return_value(Value&& value) { result.template emplace< 1 >(std::forward< Value >(value)); }
+            void unhandled_exception() noexcept { result.template emplace< 2 >(std::current_exception()); }
+
+            Type Result() {
+                if (result.index() == 2) std::rethrow_exception(std::get< 2 >(result));
+                return std::move(std::get< 1 >(result));
+            }
+
+            std::variant< std::monostate, Type, std::exception_ptr > result {};
+        };
+
+        template <>
+        struct TaskPromise< void > : TaskPromiseBase {
+            Task< void > get_return_object() noexcept;
+
+            void return_void() const noexcept {}
+            void unhandled_exception() noexcept { error = std::current_exception(); }
+
+            void Result() const {
+                if (error) std::rethrow_exception(error);
+            }
+
+            std::exception_ptr error {};
+        };
+
+    } // namespace impl
+
+    /// <summary>
+    /// Lazily started coroutine producing a Type, awaiting it runs it and yields its result (or rethrows its exception)
+    /// A task is awaited at most once
+    /// </summary>
+    template < class Type >
+    class [[nodiscard]] Task {
+        static_assert(!std::is_reference_v< Type >, "Task results are returned by value");
+
+      public:
+        using promise_type = impl::TaskPromise< Type >;
+        using value_type   = Type;
+
+        Task() noexcept = default;
+        explicit Task(std::coroutine_handle< promise_type > handle_) noexcept : handle(handle_) {}
+        Task(Task&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+        Task& operator=(Task&& other) noexcept {
+            if (this != &other) {
+                if (handle) handle.destroy();
+                handle = std::exchange(other.handle, nullptr);
+            }
+            return *this;
+        }
+        Task(const Task&) = delete;
+        Task& operator=(const Task&) = delete;
+        ~Task() {
+            if (handle) handle.destroy();
+        }
+
+        [[nodiscard]] explicit operator bool() const noexcept { return static_cast< bool >(handle); }
+
+        bool                    await_ready() const noexcept { return !handle || handle.done(); }
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+            handle.promise().continuation = awaiting;
+            return handle;
+        }
+        Type await_resume() { return handle.promise().Result(); }
+
+      private:
+        std::coroutine_handle< promise_type > handle {};
+    };
+
+    namespace impl {
+
+        template < class Type >
+        Task< Type > TaskPromise< Type >::get_return_object() noexcept {
+            return Task< Type > { std::coroutine_handle< TaskPromise >::from_promise(*this) };
+        }
+        inline Task< void > TaskPromise< void >::get_return_object() noexcept {
+            return Task< void > { std::coroutine_handle< TaskPromise >::from_promise(*this) };
+        }
+
+        // Eagerly started coroutine that destroys itself when it finishes, used to drive tasks from outside a coroutine
+        struct DetachedTask {
+            struct promise_type {
+                DetachedTask        get_return_object() const noexcept { return {}; }
+                std::suspend_never  initial_suspend() const noexcept { return {}; }
+                std::suspend_never  final_suspend() const noexcept { return {}; }
+                void                return_void() const noexcept {}
+                [[noreturn]] void   unhandled_exception() const noexcept { std::terminate(); }
+            };
+        };
+
+        struct ScheduleAwaiter {
+            TaskScheduler& scheduler;
+
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> handle) const {
+                scheduler.Submit([handle]() { handle.resume(); });
+            }
+            void await_resume() const noexcept {}
+        };
+
+        // Result of a synchronous stage, awaiting it does not suspend
+        template < class Type >
+        struct ReadyAwaiter {
+            Type value;
+
+            bool await_ready() const noexcept { return true; }
+            void await_suspend(std::coroutine_handle<>) const noexcept {}
+            Type await_resume() { return std::move(value); }
+        };
+
+        template < class >
+        inline constexpr bool is_task = false;
+        template < class Type >
+        inline constexpr bool is_task< Task< Type > > = true;
+
+        template < class Type >
+        struct awaited {
+            using type = Type;
+        };
+        template < class Type >
+        struct awaited< Task< Type > > {
+            using type = Type;
+        };
+        template < class Type >
+        using awaited_t = typename awaited< std::remove_cvref_t< Type > >::type;
+
+        template < class Value >
+        decltype(auto) AsAwaitable(Value&& value) {
+            if constexpr (is_task< std::remove_cvref_t< Value > >) {
+                return std::forward< Value >(value);
+            } else {
+                return ReadyAwaiter< std::remove_cvref_t< Value > > { std::forward< Value >(value) };
+            }
+        }
+
+        template < class Type >
+        DetachedTask AwaitInto(Task< Type >& task, std::optional< std::conditional_t< std::is_void_v< Type >, std::monostate, Type > >& value,
+                               std::exception_ptr& error, std::atomic< bool >& done) {
+            try {
+                if constexpr (std::is_void_v< Type >) {
+                    co_await task;
+                    value.emplace();
+                } else {
+                    value.emplace(co_await task);
+                }
+            } catch (...) { error = std::current_exception(); }
+            done.store(true, std::memory_order_release);
+        }
+
+        // Counts the tasks of a WhenAll still running, the last one to finish resumes the awaiting coroutine
+        struct WhenAllLatch {
+            explicit WhenAllLatch(std::size_t count) : remaining(count + 1) {}
+
+            void Arrive() {
+                if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) continuation.resume();
+            }
+
+            std::atomic< std::size_t > remaining;
+            std::coroutine_handle<>    continuation {};
+            std::mutex                 errorMutex {};
+            std::exception_ptr         error {};
+        };
+
+        template < class Type >
+        DetachedTask RunOn(TaskScheduler& scheduler, Task< Type >& task, std::optional< Type >& slot, WhenAllLatch& latch) {
+            co_await ScheduleAwaiter { scheduler };
+            try {
+                slot.emplace(co_await task);
+            } catch (...) {
+                std::scoped_lock lock { latch.errorMutex };
+                if (!latch.error) latch.error = std::current_exception();
+            }
+            latch.Arrive();
+        }
+
+        template < class Start >
+        struct WhenAllAwaiter {
+            WhenAllLatch& latch;
+            Start         start;
+
+            bool await_ready() const noexcept { return false; }
+            bool await_suspend(std::coroutine_handle<> handle) {
+                latch.continuation = handle;
+                start();
+                // The extra count held while starting: if every task already finished, continue without suspending
+                return latch.remaining.fetch_sub(1, std::memory_order_acq_rel) != 1;
+            }
+            void await_resume() const noexcept {}
+        };
+
+    } // namespace impl
+
+    // Awaiting the result moves the rest of the coroutine onto a worker of scheduler
+    [[nodiscard]] inline impl::ScheduleAwaiter ScheduleOn(TaskScheduler& scheduler = TaskScheduler::Default()) noexcept { return { scheduler }; }
+
+    /// <summary>
+    /// Runs every task concurrently on scheduler, the results keep the order of the tasks
+    /// Once all tasks have finished the first exception thrown by one of them is rethrown
+    /// </summary>
+    template < class Type >
+    requires(!std::is_void_v< Type >) Task< std::vector< Type > > WhenAll(std::vector< Task< Type > > tasks, TaskScheduler& scheduler = TaskScheduler::Default()) {
+        std::vector< std::optional< Type > > slots(tasks.size());
+        impl::WhenAllLatch                   latch { tasks.size() };
+
+        auto start = [&]() {
+            for (std::size_t i = 0; i < tasks.size(); ++i) { impl::RunOn(scheduler, tasks[i], slots[i], latch); }
+        };
+        co_await impl::WhenAllAwaiter< decltype(start) > { latch, start };
+
+        if (latch.error) std::rethrow_exception(latch.error);
+        std::vector< Type > results;
+        results.reserve(slots.size());
+        for (auto& slot : slots) { results.push_back(std::move(*slot)); }
+        co_return results;
+    }
+
+    /// <summary>
+    /// Blocks the calling thread until task has finished and returns its result, pending scheduler tasks are run meanwhile
+    /// Must not be called from a coroutine
+    /// </summary>
+    template < class Type >
+    Type SyncWait(Task< Type > task, TaskScheduler& scheduler = TaskScheduler::Default()) {
+        std::optional< std::conditional_t< std::is_void_v< Type >, std::monostate, Type > > value {};
+        std::exception_ptr                                                                  error {};
+        std::atomic< bool >                                                                 done { false };
+
+        impl::AwaitInto(task, value, error, done);
+        while (!done.load(std::memory_order_acquire)) {
+            if (!scheduler.RunPendingTask()) std::this_thread::yield();
+        }
+
+        if (error) std::rethrow_exception(error);
+        if constexpr (!std::is_void_v< Type >) return std::move(*value);
+    }
+
+    namespace impl {
+
+        template < class FirstCallable, class SecondCallable >
+        struct is_async_composable {
+          private:
+            using first_return = awaited_t< typename functor_traits< FirstCallable >::return_type >;
+            using second_args  = typename functor_traits< SecondCallable >::argument_types;
+
+          public:
+            static constexpr auto value = count_list_element< second_args >::value == 1 &&
+                                          std::same_as< std::remove_cvref_t< typename pop_first_from_list< second_args >::type >, std::remove_cvref_t< first_return > >;
+        };
+
+        template < class... Stages >
+        inline constexpr bool async_chain_composable = true;
+        template < class First, class Second, class... Rest >
+        inline constexpr bool async_chain_composable< First, Second, Rest... > =
+            is_async_composable< First, Second >::value && async_chain_composable< Second, Rest... >;
+
+        template < class RetType, class ArgsList, class... Stages >
+        struct AsyncComposedFunction;
+
+        /// <summary>
+        /// The callable of ComposeAsync: every call returns a Task running the stages one after the other
+        /// The stages are shared with the running tasks, so a task may outlive the callable that started it
+        /// </summary>
+        template < class RetType, template < class... > class List, class... Args, class... Stages >
+        struct AsyncComposedFunction< RetType, List< Args... >, Stages... > {
+            using stages_type = std::tuple< Stages... >;
+
+            static constexpr std::size_t stage_count = sizeof...(Stages);
+
+            std::shared_ptr< stages_type > stages;
+
+            Task< RetType > operator()(Args... args) const { return Run(stages, std::forward< Args >(args)...); }
+
+          private:
+            static Task< RetType > Run(std::shared_ptr< stages_type > stages, Args... args) {
+                auto value = co_await AsAwaitable(std::get< 0 >(*stages)(std::forward< Args >(args)...));
+                if constexpr (stage_count == 1) {
+                    co_return value;
+                } else {
+                    co_return co_await Continue< 1 >(*stages, std::move(value));
+                }
+            }
+
+            template < std::size_t Index, class Value >
+            static Task< RetType > Continue(stages_type& stages, Value value) {
+                auto next = co_await AsAwaitable(std::get< Index >(stages)(std::move(value)));
+                if constexpr (Index + 1 == stage_count) {
+                    co_return next;
+                } else {
+                    co_return co_await Continue< Index + 1 >(stages, std::move(next));
+                }
+            }
+        };
+
+    } // namespace impl
+
+    /// <summary>
+    /// Asynchronous flavor of Pipe: ComposeAsync(X, Y, Z)(args) -> Task of Z(Y(X(args)))
+    /// A stage either returns its value or a Task of it, a Task is awaited before the next stage runs so a stage
+    /// waiting for I/O suspends its chain instead of blocking a thread. Stages are stored like in Compose.
+    /// </summary>
+    /// <param name="callables">Stages in call order, each one composable with the next once its Task is awaited</param>
+    /// <returns>Callable returning a Task</returns>
+    template < class... Callables >
+    requires(sizeof...(Callables) > 0 && impl::async_chain_composable< std::decay_t< Callables >... >) [[nodiscard]] auto ComposeAsync(Callables&&... callables) {
+        using First    = std::tuple_element_t< 0, std::tuple< std::decay_t< Callables >... > >;
+        using Last     = std::tuple_element_t< sizeof...(Callables) - 1, std::tuple< std::decay_t< Callables >... > >;
+        using RetType  = impl::awaited_t< typename functor_traits< Last >::return_type >;
+        using ArgsList = typename functor_traits< First >::argument_types;
+        using Composed = impl::AsyncComposedFunction< RetType, ArgsList, std::decay_t< Callables >... >;
+
+        return Composed { std::make_shared< typename Composed::stages_type >(std::forward< Callables >(callables)...) };
+    }
+
+} // namespace fp
+
+#endif // TASK_FP
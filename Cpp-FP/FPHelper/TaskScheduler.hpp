@@ -0,0 +1,258 @@
+// TaskScheduler.hpp: Work-stealing thread pool shared by the FPHelper parallel operators
+//
+// Every worker owns a deque: it pushes and pops its own tasks at the back (LIFO, cache friendly)
+// while idle workers steal from the front of a random victim. Threads waiting on a TaskGroup
+// execute pending tasks instead of blocking, so nested parallel loops reuse the same workers
+// and never spawn extra threads.
+
+#ifndef TASK_SCHEDULER_FP
+#define TASK_SCHEDULER_FP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace fp {
+
+    class TaskScheduler {
+      public:
+        using Task = std::function< void() >;
+
+        explicit TaskScheduler(std::size_t workerCount = DefaultWorkerCount()) : workers(workerCount) {
+            for (std::size_t i = 0; i < workers.size(); ++i) {
+                workers[i] = std::make_unique< Worker >();
+            }
+            for (std::size_t i = 0; i < workers.size(); ++i) {
+                workers[i]->thread = std::thread { [this, i]() { WorkerLoop(i); } };
+            }
+        }
+        ~TaskScheduler() {
+            {
+                std::scoped_lock lock { sleepMutex };
+                stopping = true;
+            }
+            sleepCondition.notify_all();
+            for (auto& worker : workers) { worker->thread.join(); }
+        }
+
+        TaskScheduler(const TaskScheduler&) = delete;
+        TaskScheduler(TaskScheduler&&)      = delete;
+        TaskScheduler& operator=(const TaskScheduler&) = delete;
+        TaskScheduler& operator=(TaskScheduler&&) = delete;
+
+        // Process wide scheduler used by the library when none is given explicitly
+        [[nodiscard]] static TaskScheduler& Default() {
+            static TaskScheduler scheduler {};
+            return scheduler;
+        }
+
+        [[nodiscard]] static std::size_t DefaultWorkerCount() noexcept {
+            const auto hardware = std::thread::hardware_concurrency();
+            return hardware > 1 ? hardware - 1 : 1;
+        }
+
+        // Number of threads that execute tasks: the workers plus the thread waiting on the result
+        [[nodiscard]] std::size_t Concurrency() const noexcept { return workers.size() + 1; }
+
+        // Tasks submitted from a worker go to its own deque, others go to the shared injection queue
+        void Submit(Task task) {
+            if (currentScheduler == this) {
+                auto& worker = *workers[currentWorker];
+                std::scoped_lock lock { worker.mutex };
+                worker.tasks.push_back(std::move(task));
+            } else {
+                std::scoped_lock lock { injectionMutex };
+                injection.push_back(std::move(task));
+            }
+            queued.fetch_add(1);
+
+            if (sleeping.load() > 0) {
+                { std::scoped_lock lock { sleepMutex }; }
+                sleepCondition.notify_one();
+            }
+        }
+
+        // Runs at most one pending task on the calling thread, returns false if there was none
+        bool RunPendingTask() {
+            Task task {};
+            if (!TryTake(task)) return false;
+
+            queued.fetch_sub(1);
+            task();
+            return true;
+        }
+
+      private:
+        struct Worker {
+            std::mutex         mutex {};
+            std::deque< Task > tasks {};
+            std::thread        thread {};
+        };
+
+        void WorkerLoop(std::size_t index) {
+            currentScheduler = this;
+            currentWorker    = index;
+
+            while (true) {
+                if (RunPendingTask()) continue;
+
+                std::unique_lock lock { sleepMutex };
+                sleeping.fetch_add(1);
+                sleepCondition.wait(lock, [this]() { return stopping || queued.load() > 0; });
+                sleeping.fetch_sub(1);
+                if (stopping) return;
+            }
+        }
+
+        bool TryTake(Task& task) {
+            if (currentScheduler == this && PopBack(*workers[currentWorker], task)) return true;
+            {
+                std::scoped_lock lock { injectionMutex };
+                if (!injection.empty()) {
+                    task = std::move(injection.front());
+                    injection.pop_front();
+                    return true;
+                }
+            }
+
+            const auto count = workers.size();
+            const auto start = static_cast< std::size_t >(NextRandom() % std::max< std::size_t >(count, 1));
+            for (std::size_t i = 0; i < count; ++i) {
+                const auto victim = (start + i) % count;
+                if (currentScheduler == this && victim == currentWorker) continue;
+                if (StealFront(*workers[victim], task)) return true;
+            }
+            return false;
+        }
+
+        static bool PopBack(Worker& worker, Task& task) {
+            std::scoped_lock lock { worker.mutex };
+            if (worker.tasks.empty()) return false;
+            task = std::move(worker.tasks.back());
+            worker.tasks.pop_back();
+            return true;
+        }
+
+        static bool StealFront(Worker& worker, Task& task) {
+            std::unique_lock lock { worker.mutex, std::try_to_lock };
+            if (!lock.owns_lock() || worker.tasks.empty()) return false;
+            task = std::move(worker.tasks.front());
+            worker.tasks.pop_front();
+            return true;
+        }
+
+        static std::uint64_t NextRandom() noexcept {
+            thread_local std::uint64_t state = std::hash< std::thread::id > {}(std::this_thread::get_id()) | 1;
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            return state;
+        }
+
+        inline static thread_local TaskScheduler* currentScheduler = nullptr;
+        inline static thread_local std::size_t    currentWorker    = 0;
+
+        std::vector< std::unique_ptr< Worker > > workers;
+        std::mutex                               injectionMutex {};
+        std::deque< Task >                       injection {};
+        std::atomic< std::size_t >               queued { 0 };
+        std::atomic< std::size_t >               sleeping { 0 };
+        std::mutex                               sleepMutex {};
+        std::condition_variable                  sleepCondition {};
+        bool                                     stopping = false;
+    };
+
+    /// <summary>
+    /// Fork/join scope: Run() forks tasks onto the scheduler, Wait() joins them while helping to execute them
+    /// The first exception thrown by a task is rethrown from Wait()
+    /// </summary>
+    class TaskGroup {
+      public:
+        explicit TaskGroup(TaskScheduler& scheduler_ = TaskScheduler::Default()) : scheduler(scheduler_) {}
+        ~TaskGroup() {
+            try {
+                Wait();
+            } catch (...) {}
+        }
+
+        TaskGroup(const TaskGroup&) = delete;
+        TaskGroup& operator=(const TaskGroup&) = delete;
+
+        template < class Func >
+        void Run(Func&& func) {
+            pending.fetch_add(1);
+            scheduler.Submit([this, func_ = std::forward< Func >(func)]() mutable {
+                try {
+                    func_();
+                } catch (...) {
+                    std::scoped_lock lock { errorMutex };
+                    if (!error) error = std::current_exception();
+                }
+                pending.fetch_sub(1, std::memory_order_release);
+            });
+        }
+
+        void Wait() {
+            while (pending.load(std::memory_order_acquire) > 0) {
+                if (!scheduler.RunPendingTask()) std::this_thread::yield();
+            }
+            if (error) std::rethrow_exception(std::exchange(error, nullptr));
+        }
+
+        [[nodiscard]] TaskScheduler& Scheduler() const noexcept { return scheduler; }
+
+      private:
+        TaskScheduler&             scheduler;
+        std::atomic< std::size_t > pending { 0 };
+        std::mutex                 errorMutex {};
+        std::exception_ptr         error {};
+    };
+
+    namespace impl {
+        // Splits [first, last) in halves, forking the upper half, until a range is no larger than grain
+        template < class Func >
+        void SplitRange(TaskGroup& group, std::size_t first, std::size_t last, std::size_t grain, Func& func) {
+            while (last - first > grain) {
+                const auto middle = first + (last - first) / 2;
+                group.Run([&group, middle, last, grain, &func]() { SplitRange(group, middle, last, grain, func); });
+                last = middle;
+            }
+            for (; first < last; ++first) { func(first); }
+        }
+    } // namespace impl
+
+    /// <summary>
+    /// Invokes func(i) for every i in [first, last), ranges of at most grain indices run as one task
+    /// </summary>
+    template < class Func >
+    void parallel_for(std::size_t first, std::size_t last, std::size_t grain, Func&& func, TaskScheduler& scheduler = TaskScheduler::Default()) {
+        if (first >= last) return;
+        TaskGroup group { scheduler };
+        impl::SplitRange(group, first, last, std::max< std::size_t >(grain, 1), func);
+        group.Wait();
+    }
+
+    /// <summary>
+    /// Runs all callables concurrently and returns once every one of them has finished
+    /// </summary>
+    template < class Func, class... Funcs >
+    void parallel_invoke(Func&& func, Funcs&&... funcs) {
+        TaskGroup group {};
+        (group.Run(std::ref(funcs)), ...);
+        func();
+        group.Wait();
+    }
+
+} // namespace fp
+
+#endif // TASK_SCHEDULER_FP
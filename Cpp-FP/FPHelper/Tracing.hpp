@@ -0,0 +1,291 @@
+// Tracing.hpp: Opt-in instrumentation of the FPHelper operators
+//
+// Built with FP_ENABLE_TRACING, every LinqContainer/LinqPipeline/Enumerable operator and every Compose/Pipe
+// stage records its element counts, the bytes it allocated and its wall time into the Collector installed
+// on the calling thread (ScopedCollector). Without FP_ENABLE_TRACING the operators compile exactly as before:
+// OperatorScope is empty and Invoke is a plain call.
+// Stages of a lazy pipeline run fused in one loop, they report their counts and the terminal operator the time.
+
+#ifndef TRACING_FP
+#define TRACING_FP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace fp::trace {
+
+#ifdef FP_ENABLE_TRACING
+    inline constexpr bool enabled = true;
+#else
+    inline constexpr bool enabled = false;
+#endif
+
+    // Stage of an operator that is not part of a composition or of a lazy pipeline
+    inline constexpr std::size_t no_stage = static_cast< std::size_t >(-1);
+
+    // One call of an operator. Times are nanoseconds since the collector was created
+    struct Event {
+        const char*   name           = "";
+        std::size_t   stage          = no_stage;
+        std::size_t   elementsIn     = 0;
+        std::size_t   elementsOut    = 0;
+        std::size_t   bytesAllocated = 0;
+        std::uint64_t start          = 0;
+        std::uint64_t duration       = 0;
+        std::uint32_t thread         = 0;
+
+        // Fraction of the elements let through, 1 for operators without input
+        [[nodiscard]] double Selectivity() const noexcept { return elementsIn == 0 ? 1. : static_cast< double >(elementsOut) / elementsIn; }
+    };
+
+    // Totals of one operator (and stage) over all its calls
+    struct OperatorSummary {
+        const char*   name           = "";
+        std::size_t   stage          = no_stage;
+        std::size_t   calls          = 0;
+        std::size_t   elementsIn     = 0;
+        std::size_t   elementsOut    = 0;
+        std::size_t   bytesAllocated = 0;
+        std::uint64_t duration       = 0;
+
+        [[nodiscard]] double Selectivity() const noexcept { return elementsIn == 0 ? 1. : static_cast< double >(elementsOut) / elementsIn; }
+    };
+
+    namespace impl {
+        // Small stable thread numbers for the trace viewer
+        inline std::uint32_t ThreadIndex() noexcept {
+            static std::atomic< std::uint32_t > next { 0 };
+            thread_local const std::uint32_t    index = next++;
+            return index;
+        }
+
+        inline void WriteJsonString(std::ostream& out, const char* text) {
+            out << '"';
+            for (; *text != '\0'; ++text) {
+                const auto character = static_cast< unsigned char >(*text);
+                if (character == '"' || character == '\\') {
+                    out << '\\' << *text;
+                } else if (character < 0x20) {
+                    out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast< int >(character) << std::dec << std::setfill(' ');
+                } else {
+                    out << *text;
+                }
+            }
+            out << '"';
+        }
+
+        inline std::string StageName(const char* name, std::size_t stage) {
+            return stage == no_stage ? std::string { name } : std::string { name } + '[' + std::to_string(stage) + ']';
+        }
+    } // namespace impl
+
+    /// <summary>
+    /// Events of one pipeline (or of everything run while it is installed), safe to share between threads.
+    /// Only the first maxEvents calls are kept as events, the summary counts every call
+    /// </summary>
+    class Collector {
+      public:
+        explicit Collector(std::size_t maxEvents_ = std::size_t { 1 } << 16) : maxEvents(maxEvents_), epoch(std::chrono::steady_clock::now()) {}
+
+        Collector(const Collector&) = delete;
+        Collector& operator=(const Collector&) = delete;
+
+        [[nodiscard]] std::uint64_t Now() const noexcept {
+            return static_cast< std::uint64_t >(std::chrono::duration_cast< std::chrono::nanoseconds >(std::chrono::steady_clock::now() - epoch).count());
+        }
+
+        // Never throws, an event that cannot be stored is dropped
+        void Record(const Event& event) noexcept {
+            try {
+                std::lock_guard lock { mutex };
+                auto            summary = std::find_if(summaries.begin(), summaries.end(), [&event](const OperatorSummary& candidate) {
+                    return candidate.stage == event.stage && std::strcmp(candidate.name, event.name) == 0;
+                });
+                if (summary == summaries.end()) summary = summaries.insert(summaries.end(), OperatorSummary { event.name, event.stage });
+                ++summary->calls;
+                summary->elementsIn += event.elementsIn;
+                summary->elementsOut += event.elementsOut;
+                summary->bytesAllocated += event.bytesAllocated;
+                summary->duration += event.duration;
+
+                if (events.size() < maxEvents) {
+                    events.push_back(event);
+                } else {
+                    ++dropped;
+                }
+            } catch (...) { }
+        }
+
+        [[nodiscard]] std::vector< Event > Events() const {
+            std::lock_guard lock { mutex };
+            return events;
+        }
+        // One entry per operator and stage, in the order they were first seen
+        [[nodiscard]] std::vector< OperatorSummary > Summary() const {
+            std::lock_guard lock { mutex };
+            return summaries;
+        }
+        [[nodiscard]] std::size_t DroppedEvents() const {
+            std::lock_guard lock { mutex };
+            return dropped;
+        }
+
+        void Clear() {
+            std::lock_guard lock { mutex };
+            events.clear();
+            summaries.clear();
+            dropped = 0;
+        }
+
+        // Per-operator table: calls, elements in and out, selectivity, bytes allocated and wall time
+        void WriteReport(std::ostream& out) const {
+            const auto summary   = Summary();
+            const auto flags     = out.flags();
+            const auto precision = out.precision();
+            out << std::left << std::setw(28) << "operator" << std::right << std::setw(10) << "calls" << std::setw(14) << "in" << std::setw(14) << "out"
+                << std::setw(13) << "selectivity" << std::setw(14) << "bytes" << std::setw(14) << "time (us)" << '\n';
+            for (const auto& entry : summary) {
+                out << std::left << std::setw(28) << impl::StageName(entry.name, entry.stage) << std::right << std::setw(10) << entry.calls << std::setw(14)
+                    << entry.elementsIn << std::setw(14) << entry.elementsOut << std::setw(13) << std::fixed << std::setprecision(3) << entry.Selectivity()
+                    << std::setw(14) << entry.bytesAllocated << std::setw(14) << std::setprecision(1) << entry.duration / 1000. << '\n';
+            }
+            out.flags(flags);
+            out.precision(precision);
+            if (const auto lost = DroppedEvents(); lost != 0) out << lost << " calls were summarized without an event\n";
+        }
+
+        // Chrome trace-event format (chrome://tracing, Perfetto): one complete event per call
+        void WriteChromeTrace(std::ostream& out) const {
+            const auto recorded  = Events();
+            const auto flags     = out.flags();
+            const auto precision = out.precision();
+            out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+            for (std::size_t i = 0; i < recorded.size(); ++i) {
+                const auto& event = recorded[i];
+                out << (i == 0 ? "\n" : ",\n") << "{\"name\":";
+                impl::WriteJsonString(out, impl::StageName(event.name, event.stage).c_str());
+                out << ",\"cat\":\"fp\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.thread << std::fixed << std::setprecision(3)
+                    << ",\"ts\":" << event.start / 1000. << ",\"dur\":" << event.duration / 1000. << ",\"args\":{\"elements_in\":" << event.elementsIn
+                    << ",\"elements_out\":" << event.elementsOut << ",\"bytes_allocated\":" << event.bytesAllocated << ",\"selectivity\":" << event.Selectivity()
+                    << "}}";
+            }
+            out << "\n]}\n";
+            out.flags(flags);
+            out.precision(precision);
+        }
+
+      private:
+        const std::size_t                           maxEvents;
+        const std::chrono::steady_clock::time_point epoch;
+        mutable std::mutex                          mutex {};
+        std::vector< Event >                        events {};
+        std::vector< OperatorSummary >              summaries {};
+        std::size_t                                 dropped = 0;
+    };
+
+    namespace impl {
+        inline Collector*& CurrentSlot() noexcept {
+            thread_local Collector* current = nullptr;
+            return current;
+        }
+    } // namespace impl
+
+    // Collector the calling thread records into, always nullptr without FP_ENABLE_TRACING
+    inline Collector* Current() noexcept {
+        if constexpr (enabled) {
+            return impl::CurrentSlot();
+        } else {
+            return nullptr;
+        }
+    }
+
+    // Installs a collector on the calling thread for its lifetime, the previous one is restored afterwards
+    class ScopedCollector {
+      public:
+        explicit ScopedCollector(Collector& collector) noexcept : previous(std::exchange(impl::CurrentSlot(), &collector)) {}
+        ScopedCollector(const ScopedCollector&) = delete;
+        ScopedCollector& operator=(const ScopedCollector&) = delete;
+        ~ScopedCollector() { impl::CurrentSlot() = previous; }
+
+      private:
+        Collector* previous;
+    };
+
+#ifdef FP_ENABLE_TRACING
+    /// <summary>
+    /// Times one call of an operator, from construction to destruction, into the current collector.
+    /// Output() sets what the call produced, a call that leaves through an exception records what it had
+    /// </summary>
+    class OperatorScope {
+      public:
+        OperatorScope(const char* name, std::size_t elementsIn, std::size_t stage = no_stage) noexcept : collector(Current()) {
+            if (collector == nullptr) return;
+            event.name       = name;
+            event.stage      = stage;
+            event.elementsIn = elementsIn;
+            event.thread     = impl::ThreadIndex();
+            event.start      = collector->Now();
+        }
+        OperatorScope(const OperatorScope&) = delete;
+        OperatorScope& operator=(const OperatorScope&) = delete;
+        ~OperatorScope() {
+            if (collector == nullptr) return;
+            event.duration = collector->Now() - event.start;
+            collector->Record(event);
+        }
+
+        // Input is only known at the end for lazy pipelines
+        void Input(std::size_t elementsIn) noexcept { event.elementsIn = elementsIn; }
+
+        void Output(std::size_t elementsOut, std::size_t bytesAllocated = 0) noexcept {
+            event.elementsOut    = elementsOut;
+            event.bytesAllocated = bytesAllocated;
+        }
+
+      private:
+        Collector* collector;
+        Event      event {};
+    };
+#else
+    class OperatorScope {
+      public:
+        constexpr OperatorScope(const char*, std::size_t, std::size_t = no_stage) noexcept {}
+        constexpr void Input(std::size_t) noexcept {}
+        constexpr void Output(std::size_t, std::size_t = 0) noexcept {}
+    };
+#endif
+
+    namespace impl {
+        template < class Function, class... Args >
+        decltype(auto) TimedInvoke(const char* name, std::size_t stage, Function& function, Args&&... args) noexcept(std::is_nothrow_invocable_v< Function&, Args... >) {
+            OperatorScope scope { name, 1, stage };
+            scope.Output(1);
+            return std::invoke(function, std::forward< Args >(args)...);
+        }
+    } // namespace impl
+
+    // Calls one stage of a composition, timed when tracing is enabled and the call is not constant evaluated
+    template < class Function, class... Args >
+    constexpr decltype(auto) Invoke([[maybe_unused]] const char* name, [[maybe_unused]] std::size_t stage, Function& function,
+                                    Args&&... args) noexcept(std::is_nothrow_invocable_v< Function&, Args... >) {
+        if constexpr (enabled) {
+            if (!std::is_constant_evaluated()) return impl::TimedInvoke(name, stage, function, std::forward< Args >(args)...);
+        }
+        return std::invoke(function, std::forward< Args >(args)...);
+    }
+
+} // namespace fp::trace
+
+#endif // TRACING_FP
@@ -7,6 +7,7 @@
 #define TRAITS_FP
 
 #include <stdint.h>
+#include <functional>
 #include <type_traits>
 #include <utility>
 
@@ -22,6 +23,15 @@ namespace fp {
         lhs / rhs;
     };
 
+    // Accumulator of a sum of Type: 64 bits for integers so narrow integers do not overflow, double for float
+    template < class Type >
+    using sum_t = std::conditional_t< std::is_integral_v< Type >, std::conditional_t< std::is_signed_v< Type >, int64_t, uint64_t >,
+                                      std::conditional_t< std::is_same_v< Type, float >, double, Type > >;
+
+    // Result of averaging Type: integers average to double instead of truncating
+    template < class Type >
+    using average_t = std::conditional_t< std::is_integral_v< Type >, double, Type >;
+
     template < typename Type, typename T >
     concept has_compose = requires(Type type) {
         type.Compose(T {});
@@ -137,6 +147,9 @@ namespace fp {
     };
     template < class Type >
     requires std::is_class_v< Type > struct functor_traits< Type > : public functor_traits< decltype(&Type::operator()) > {};
+    // A borrowed callable (std::ref / std::cref) has the signature of the callable it refers to
+    template < class Type >
+    struct functor_traits< std::reference_wrapper< Type > > : public functor_traits< std::remove_cv_t< Type > > {};
 
     // Type traits
     template < class FirstCallable, class SecondCallable >